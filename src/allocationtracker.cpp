@@ -0,0 +1,192 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "allocationtracker.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if WORKBENCH_ALLOCATION_TRACKING
+
+// trivial thread-locals, so these are safe to use at any point of a thread's lifetime
+static thread_local qint64 t_allocationCount = 0;
+static thread_local qint64 t_allocatedBytes = 0;
+
+static void countAllocation(std::size_t size) noexcept
+{
+    ++t_allocationCount;
+    t_allocatedBytes += size;
+}
+
+#ifdef __GLIBC__
+
+// interpose the malloc family, which also covers operator new as well as QArrayData based
+// Qt containers, forwarding to the glibc implementation
+// free() and friends don't need interposing, as the memory still comes from glibc's allocator
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void *ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+void* malloc(std::size_t size) noexcept
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void *ptr, std::size_t size) noexcept
+{
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept
+{
+    countAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    countAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, std::size_t alignment, std::size_t size) noexcept
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    countAllocation(size);
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+}
+
+bool AllocationTracker::coversMalloc()
+{
+    return true;
+}
+
+#else
+
+static void* trackedAlloc(std::size_t size) noexcept
+{
+    countAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+static void* trackedAlignedAlloc(std::size_t size, std::align_val_t alignment) noexcept
+{
+    countAllocation(size);
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires the size to be a multiple of the alignment
+    return std::aligned_alloc(align, std::max<std::size_t>(1, (size + align - 1) / align) * align);
+}
+
+void* operator new(std::size_t size)
+{
+    if (auto p = trackedAlloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (auto p = trackedAlignedAlloc(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return trackedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return trackedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+bool AllocationTracker::coversMalloc()
+{
+    return false;
+}
+
+#endif
+
+bool AllocationTracker::isEnabled()
+{
+    return true;
+}
+
+AllocationTracker::Counters AllocationTracker::threadCounters()
+{
+    return { t_allocationCount, t_allocatedBytes };
+}
+
+#else
+
+bool AllocationTracker::isEnabled()
+{
+    return false;
+}
+
+bool AllocationTracker::coversMalloc()
+{
+    return false;
+}
+
+AllocationTracker::Counters AllocationTracker::threadCounters()
+{
+    return {};
+}
+
+#endif
@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <QtGlobal>
+
+/** Per-thread heap allocation counters.
+ *  Only available when built with WORKBENCH_ALLOCATION_TRACKING.
+ *  With glibc this covers everything allocated via malloc, including Qt's containers,
+ *  elsewhere only allocations done via C++ operator new are counted.
+ */
+namespace AllocationTracker
+{
+
+class Counters
+{
+public:
+    qint64 count = 0;
+    qint64 bytes = 0;
+};
+
+bool isEnabled();
+/** Whether allocations via malloc are counted as well, rather than only those via operator new. */
+bool coversMalloc();
+/** Allocations done by the calling thread so far. */
+Counters threadCounters();
+
+}
+
+#endif // ALLOCATIONTRACKER_H
@@ -0,0 +1,204 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "barcodebenchmark.h"
+
+#include <KItinerary/BarcodeDecoder>
+#include <KItinerary/PdfDocument>
+
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QIODevice>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+using namespace KItinerary;
+
+namespace {
+struct HintSet {
+    const char *name;
+    BarcodeDecoder::BarcodeTypes hints;
+};
+}
+
+// the combinations the extractors and the workbench use, and each 2D format on its own
+static const HintSet s_hintSets[] = {
+    { "Any | IgnoreAspectRatio", BarcodeDecoder::Any | BarcodeDecoder::IgnoreAspectRatio },
+    { "Any", BarcodeDecoder::Any },
+    { "AnySquare", BarcodeDecoder::AnySquare },
+    { "Aztec", BarcodeDecoder::Aztec },
+    { "QRCode", BarcodeDecoder::QRCode },
+    { "DataMatrix", BarcodeDecoder::DataMatrix },
+    { "PDF417", BarcodeDecoder::PDF417 },
+};
+constexpr inline int HintSetCount = std::size(s_hintSets);
+
+static qint64 percentile(const std::vector<qint64> &sorted, int percent)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[std::min<std::size_t>(sorted.size() * percent / 100, sorted.size() - 1)];
+}
+
+static QString formatMs(qint64 ns)
+{
+    return QString::number(ns / 1'000'000.0, 'f', 2);
+}
+
+BarcodeBenchmark::BarcodeBenchmark() = default;
+BarcodeBenchmark::~BarcodeBenchmark() = default;
+
+void BarcodeBenchmark::setJobCount(int jobs)
+{
+    m_jobs = std::max(1, jobs);
+}
+
+void BarcodeBenchmark::setOutput(QIODevice *output)
+{
+    m_output = output;
+}
+
+void BarcodeBenchmark::addPath(const QString &path)
+{
+    if (!QFileInfo(path).isDir()) {
+        m_files.push_back(path);
+        return;
+    }
+
+    // sample directories usually contain other files as well, those aren't errors
+    QStringList nameFilters({QStringLiteral("*.pdf")});
+    const auto formats = QImageReader::supportedImageFormats();
+    for (const auto &format : formats) {
+        nameFilters.push_back(QLatin1String("*.") + QString::fromLatin1(format));
+    }
+
+    QDirIterator it(path, nameFilters, QDir::Files | QDir::Readable, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while (it.hasNext()) {
+        m_files.push_back(it.next());
+    }
+}
+
+int BarcodeBenchmark::exec()
+{
+    QTextStream err(stderr);
+    if (m_files.isEmpty()) {
+        err << "No input files found." << Qt::endl;
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto jobs = std::min<qsizetype>(m_jobs, m_files.size());
+    std::vector<std::unique_ptr<QThread>> workers;
+    workers.reserve(jobs);
+    for (auto i = 0; i < jobs; ++i) {
+        workers.emplace_back(QThread::create([this]() { runWorker(); }));
+        workers.back()->start();
+    }
+    for (const auto &worker : workers) {
+        worker->wait();
+    }
+
+    writeReport(timer.elapsed());
+    err << "Processed " << m_files.size() << " files with " << m_imageCount.load() << " images using " << jobs << " workers, failed to read: " << m_errorCount.load() << Qt::endl;
+    return m_errorCount.load() > 0 ? 1 : 0;
+}
+
+void BarcodeBenchmark::runWorker()
+{
+    std::vector<Sample> samples;
+    for (auto i = m_nextFile++; i < m_files.size(); i = m_nextFile++) {
+        const auto &fileName = m_files.at(i);
+        if (fileName.endsWith(QLatin1String(".pdf"), Qt::CaseInsensitive)) {
+            QFile f(fileName);
+            if (!f.open(QFile::ReadOnly)) {
+                ++m_errorCount;
+                continue;
+            }
+            std::unique_ptr<PdfDocument> pdf(PdfDocument::fromData(f.readAll()));
+            if (!pdf) {
+                ++m_errorCount;
+                continue;
+            }
+            for (auto j = 0; j < pdf->pageCount(); ++j) {
+                const auto page = pdf->page(j);
+                for (auto k = 0; k < page.imageCount(); ++k) {
+                    // including what the extractor would skip, full page raster images in particular
+                    auto pdfImg = page.image(k);
+                    pdfImg.setLoadingHints(PdfImage::NoHint);
+                    processImage(pdfImg.image(), samples);
+                }
+            }
+        } else {
+            QImage img;
+            if (!img.load(fileName)) {
+                ++m_errorCount;
+                continue;
+            }
+            processImage(img, samples);
+        }
+    }
+
+    std::lock_guard lock(m_samplesMutex);
+    m_samples.insert(m_samples.end(), samples.begin(), samples.end());
+}
+
+void BarcodeBenchmark::processImage(const QImage &img, std::vector<Sample> &samples)
+{
+    if (img.isNull()) {
+        return;
+    }
+    ++m_imageCount;
+
+    for (auto i = 0; i < HintSetCount; ++i) {
+        // a new decoder each time, it would otherwise answer from its cache
+        BarcodeDecoder decoder;
+        QElapsedTimer timer;
+        timer.start();
+        const auto res = decoder.decode(img, s_hintSets[i].hints);
+        samples.push_back({i, timer.nsecsElapsed(), !res.isNull()});
+    }
+}
+
+void BarcodeBenchmark::writeReport(qint64 elapsedMs)
+{
+    QTextStream out(m_output);
+    out << "Hint set\tImages\tDecoded\tHit rate\tp50 ms\tp90 ms\tp99 ms\tmax ms\tTotal ms\tTotal on misses ms\n";
+    for (auto i = 0; i < HintSetCount; ++i) {
+        std::vector<qint64> elapsed;
+        int decoded = 0;
+        qint64 total = 0;
+        qint64 missTotal = 0;
+        for (const auto &sample : m_samples) {
+            if (sample.hintSet != i) {
+                continue;
+            }
+            elapsed.push_back(sample.elapsedNs);
+            total += sample.elapsedNs;
+            if (sample.decoded) {
+                ++decoded;
+            } else {
+                missTotal += sample.elapsedNs;
+            }
+        }
+        std::sort(elapsed.begin(), elapsed.end());
+        const auto hitRate = elapsed.empty() ? 0.0 : decoded * 100.0 / elapsed.size();
+        out << s_hintSets[i].name << '\t' << elapsed.size() << '\t' << decoded << '\t' << QString::number(hitRate, 'f', 1) << "%\t"
+            << formatMs(percentile(elapsed, 50)) << '\t' << formatMs(percentile(elapsed, 90)) << '\t' << formatMs(percentile(elapsed, 99)) << '\t'
+            << formatMs(percentile(elapsed, 100)) << '\t' << formatMs(total) << '\t' << formatMs(missTotal) << '\n';
+    }
+    out << "Wall clock time: " << elapsedMs << " ms" << Qt::endl;
+}
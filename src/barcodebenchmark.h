@@ -0,0 +1,60 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef BARCODEBENCHMARK_H
+#define BARCODEBENCHMARK_H
+
+#include <QStringList>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class QIODevice;
+class QImage;
+
+/** Measures cost and hit rate of the barcode decoder with different hint sets.
+ *  Input are image files and PDF documents, for the latter all images on all pages are used.
+ */
+class BarcodeBenchmark
+{
+public:
+    BarcodeBenchmark();
+    ~BarcodeBenchmark();
+
+    /** Number of parallel workers. */
+    void setJobCount(int jobs);
+    void setOutput(QIODevice *output);
+    /** Adds a file, or all image and PDF files in a directory recursively. */
+    void addPath(const QString &path);
+
+    /** Runs the benchmark and writes the report, returns the process exit code. */
+    int exec();
+
+private:
+    /** One decoding attempt. */
+    struct Sample {
+        int hintSet = 0;
+        qint64 elapsedNs = 0;
+        bool decoded = false;
+    };
+
+    void runWorker();
+    void processImage(const QImage &img, std::vector<Sample> &samples);
+    void writeReport(qint64 elapsedMs);
+
+    QStringList m_files;
+    QIODevice *m_output = nullptr;
+    int m_jobs = 1;
+
+    std::atomic<qsizetype> m_nextFile = 0;
+    std::atomic<int> m_imageCount = 0;
+    std::atomic<int> m_errorCount = 0;
+    std::mutex m_samplesMutex;
+    std::vector<Sample> m_samples;
+};
+
+#endif // BARCODEBENCHMARK_H
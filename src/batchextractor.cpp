@@ -0,0 +1,223 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "batchextractor.h"
+#include "logcapture.h"
+#include "outputstages.h"
+
+#include <KItinerary/ExtractorRepository>
+#include <KItinerary/JsonLdDocument>
+
+#include <KMime/Message>
+
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QTextStream>
+#include <QThread>
+
+#include <vector>
+
+using namespace KItinerary;
+
+// script output of the file the current worker thread is processing
+static thread_local QJsonArray *tl_consoleOutput = nullptr;
+static QtMessageHandler s_prevMessageHandler = nullptr;
+
+static QString messageTypeName(QtMsgType type)
+{
+    switch (type) {
+        case QtDebugMsg: return QStringLiteral("debug");
+        case QtInfoMsg: return QStringLiteral("info");
+        case QtWarningMsg: return QStringLiteral("warning");
+        case QtCriticalMsg: return QStringLiteral("critical");
+        case QtFatalMsg: return QStringLiteral("error");
+    }
+    return {};
+}
+
+static void batchMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    // workers run in parallel, so rather than interleaving script output on stderr we attach it to the result of its file
+    LogMessage m;
+    if (tl_consoleOutput && LogMessage::fromQtMessage(type, context, msg, m)) {
+        QJsonObject obj;
+        obj.insert(QLatin1String("type"), messageTypeName(m.type));
+        obj.insert(QLatin1String("file"), m.file);
+        obj.insert(QLatin1String("line"), m.line);
+        obj.insert(QLatin1String("message"), m.msg);
+        tl_consoleOutput->push_back(obj);
+        return;
+    }
+    s_prevMessageHandler(type, context, msg);
+}
+
+BatchExtractor::BatchExtractor()
+{
+    // we don't have document trees to retain here, only use the on-disk tier
+    m_cache.setCapacity(0);
+}
+
+BatchExtractor::~BatchExtractor() = default;
+
+void BatchExtractor::setSettings(const ExtractorInput &settings)
+{
+    m_settings = settings;
+}
+
+void BatchExtractor::setAcceptCompleteOnly(bool acceptCompleteOnly)
+{
+    m_acceptCompleteOnly = acceptCompleteOnly;
+}
+
+void BatchExtractor::setJobCount(int jobs)
+{
+    m_jobs = std::max(1, jobs);
+}
+
+void BatchExtractor::setOutput(QIODevice *output)
+{
+    m_output = output;
+}
+
+void BatchExtractor::setCacheDirectory(const QString &path)
+{
+    m_cache.setDiskCachePath(path);
+}
+
+void BatchExtractor::addPath(const QString &path)
+{
+    if (!QFileInfo(path).isDir()) {
+        m_files.push_back(path);
+        return;
+    }
+
+    QDirIterator it(path, QDir::Files | QDir::Readable, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while (it.hasNext()) {
+        m_files.push_back(it.next());
+    }
+}
+
+int BatchExtractor::exec()
+{
+    QTextStream err(stderr);
+    if (m_files.isEmpty()) {
+        err << "No input files found." << Qt::endl;
+        return 1;
+    }
+
+    // load the extractor repository upfront, it's shared by all workers and not safe for concurrent initialization
+    QSettings settings;
+    settings.beginGroup(QLatin1String("Extractor Repository"));
+    ExtractorRepository repo;
+    repo.setAdditionalSearchPaths(settings.value(QLatin1String("SearchPaths"), QStringList()).toStringList());
+    repo.reload();
+    if (!m_cache.diskCachePath().isEmpty()) {
+        m_extractorFingerprint = ResultCache::extractorFingerprint();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    s_prevMessageHandler = qInstallMessageHandler(batchMessageHandler);
+    const auto jobs = std::min<qsizetype>(m_jobs, m_files.size());
+    std::vector<std::unique_ptr<QThread>> workers;
+    workers.reserve(jobs);
+    for (auto i = 0; i < jobs; ++i) {
+        workers.emplace_back(QThread::create([this]() { runWorker(); }));
+        workers.back()->start();
+    }
+    for (const auto &worker : workers) {
+        worker->wait();
+    }
+    qInstallMessageHandler(s_prevMessageHandler);
+
+    const auto elapsed = std::max<qint64>(1, timer.elapsed());
+    const auto bytes = m_bytes.load();
+    err << "Processed " << m_files.size() << " files (" << (bytes / 1024) << " kB) in " << elapsed << " ms using " << jobs << " workers" << Qt::endl;
+    err << "Throughput: " << (m_files.size() * 1000.0 / elapsed) << " files/s, " << (bytes * 1000.0 / 1024.0 / 1024.0 / elapsed) << " MB/s" << Qt::endl;
+    err << "Files with results: " << m_resultCount.load() << ", failed to read: " << m_errorCount.load() << Qt::endl;
+    return m_errorCount.load() > 0 ? 1 : 0;
+}
+
+void BatchExtractor::runWorker()
+{
+    ExtractorEngine engine;
+    ExtractorPipeline::setupEngine(engine, m_settings);
+    const auto context = ExtractorPipeline::createContextMessage(m_settings);
+
+    for (auto i = m_nextFile++; i < m_files.size(); i = m_nextFile++) {
+        processFile(engine, context.get(), m_files.at(i));
+    }
+    engine.clear();
+}
+
+void BatchExtractor::processFile(ExtractorEngine &engine, KMime::Message *context, const QString &fileName)
+{
+    QJsonObject obj;
+    obj.insert(QLatin1String("file"), fileName);
+
+    auto input = m_settings;
+    QString errorString;
+    if (!ExtractorPipeline::loadFile(input, fileName, &errorString)) {
+        obj.insert(QLatin1String("error"), errorString);
+        ++m_errorCount;
+    } else {
+        QElapsedTimer timer;
+        timer.start();
+
+        input.fileName = fileName;
+        m_bytes += input.data.size();
+
+        std::shared_ptr<ExtractorRun> run;
+        QByteArray cacheKey;
+        if (!m_extractorFingerprint.isEmpty()) {
+            cacheKey = ResultCache::key(input, m_extractorFingerprint);
+            run = m_cache.lookup(cacheKey);
+            obj.insert(QLatin1String("cached"), (bool)run);
+        }
+        if (!run) {
+            run = std::make_shared<ExtractorRun>();
+            tl_consoleOutput = &run->consoleOutput;
+            run->extractorOutput = ExtractorPipeline::extract(engine, input, context);
+            run->usedExtractor = engine.usedCustomExtractor();
+            engine.clear();
+            tl_consoleOutput = nullptr;
+        }
+        // cached along with the result, so the output doesn't depend on the cache state
+        if (!run->consoleOutput.isEmpty()) {
+            obj.insert(QLatin1String("console"), run->consoleOutput);
+        }
+
+        const auto hasOutputStages = run->outputStages.iCal(m_acceptCompleteOnly).has_value();
+        OutputStages stages;
+        stages.setAcceptCompleteOnly(m_acceptCompleteOnly);
+        stages.setRun(run);
+        const auto validated = stages.validated();
+        const auto iCal = stages.iCal();
+        // only now, so the on-disk tier has the downstream stages as well
+        if (!cacheKey.isEmpty() && !hasOutputStages) {
+            m_cache.insert(cacheKey, run);
+        }
+
+        obj.insert(QLatin1String("extractor"), run->usedExtractor);
+        obj.insert(QLatin1String("elapsedMs"), timer.elapsed());
+        obj.insert(QLatin1String("extractorResult"), run->extractorOutput);
+        obj.insert(QLatin1String("result"), JsonLdDocument::toJson(validated));
+        obj.insert(QLatin1String("iCal"), iCal);
+        if (!validated.isEmpty()) {
+            ++m_resultCount;
+        }
+    }
+
+    const auto line = QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+    std::lock_guard lock(m_outputMutex);
+    m_output->write(line);
+}
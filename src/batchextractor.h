@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef BATCHEXTRACTOR_H
+#define BATCHEXTRACTOR_H
+
+#include "extractorpipeline.h"
+#include "resultcache.h"
+
+#include <QStringList>
+
+#include <atomic>
+#include <mutex>
+
+class QIODevice;
+
+/** Runs the full extraction pipeline headless on a set of input files.
+ *  Results are written as one JSON object per line and input file.
+ */
+class BatchExtractor
+{
+public:
+    BatchExtractor();
+    ~BatchExtractor();
+
+    /** Extraction settings applied to all inputs, data and file name are ignored. */
+    void setSettings(const ExtractorInput &settings);
+    void setAcceptCompleteOnly(bool acceptCompleteOnly);
+    /** Number of parallel workers, each with its own extractor engine. */
+    void setJobCount(int jobs);
+    void setOutput(QIODevice *output);
+    /** Enables caching of results in @p path. */
+    void setCacheDirectory(const QString &path);
+    /** Adds a file, or all files in a directory recursively. */
+    void addPath(const QString &path);
+
+    /** Process all inputs, returns the process exit code. */
+    int exec();
+
+private:
+    void runWorker();
+    void processFile(KItinerary::ExtractorEngine &engine, KMime::Message *context, const QString &fileName);
+
+    ExtractorInput m_settings;
+    QStringList m_files;
+    QIODevice *m_output = nullptr;
+    int m_jobs = 1;
+    bool m_acceptCompleteOnly = true;
+    ResultCache m_cache;
+    QByteArray m_extractorFingerprint;
+
+    std::atomic<qsizetype> m_nextFile = 0;
+    std::atomic<qint64> m_bytes = 0;
+    std::atomic<int> m_resultCount = 0;
+    std::atomic<int> m_errorCount = 0;
+    std::mutex m_outputMutex;
+};
+
+#endif // BATCHEXTRACTOR_H
@@ -7,13 +7,29 @@
 #include "consoleoutputwidget.h"
 #include "ui_consoleoutputwidget.h"
 
+#include "logcapture.h"
+
 #include <KLocalizedString>
 
 #include <QAbstractTableModel>
 #include <QDebug>
 #include <QIcon>
+#include <QSettings>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include <cstring>
+// scripts logging in a loop easily produce tens of thousands of lines, keep only the most recent ones
+constexpr inline qsizetype MaxMessages = 10000;
+// number of runs we retain the output of, cached results can come back to older runs
+constexpr inline std::size_t MaxRunLogs = 16;
+// in ms, messages arriving within that interval are added to the model in one go
+constexpr inline int FlushInterval = 100;
 
 class ConsoleOutputModel : public QAbstractTableModel
 {
@@ -32,19 +48,51 @@ public:
     QVariant data(const QModelIndex &index, int role) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
-    void clear();
+    /** Shows the output of run @p runId, see LogScope. */
+    void setRunId(quint64 runId);
+    /** Number of messages of the current run discarded due to the retention limit. */
+    qsizetype droppedCount() const;
+    /** Whether script output is also passed on to the previous message handler, ie. printed to stderr.
+     *  Any other message is always passed on.
+     */
+    void setForwardMessages(bool forward);
 
     void handleMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 
+Q_SIGNALS:
+    void droppedCountChanged();
+
 private:
-    struct Message {
-        QString msg;
-        QString file;
-        QString function;
-        QtMsgType type;
-        int line;
+    /** Output of one run, a ring buffer of up to MaxMessages entries. */
+    struct RunLog {
+        std::vector<LogMessage> messages;
+        qsizetype head = 0;
+        qsizetype count = 0;
+        qsizetype dropped = 0;
+
+        const LogMessage& at(qsizetype row) const;
+        void append(LogMessage &&m);
+        void dropOldest(qsizetype n);
     };
-    std::vector<Message> m_messages;
+    RunLog& runLog(quint64 runId);
+    const RunLog* currentLog() const;
+
+    /** Node of the lock-free multi-producer queue message handlers on any thread write to. */
+    struct PendingMessage {
+        LogMessage msg;
+        PendingMessage *next = nullptr;
+    };
+    void enqueue(LogMessage &&m);
+    void flush();
+    void flushCurrent(std::vector<LogMessage> &&batch);
+
+    std::unordered_map<quint64, RunLog> m_logs;
+    std::deque<quint64> m_logOrder;
+    quint64 m_runId = 0;
+    QTimer m_flushTimer;
+
+    std::atomic<PendingMessage*> m_pending = nullptr;
+    std::atomic<bool> m_forwardMessages = true;
     QtMessageHandler m_prevHandler = nullptr;
 };
 
@@ -55,9 +103,49 @@ void messageHandler(QtMsgType type, const QMessageLogContext &context, const QSt
     sConsoleOutput->handleMessage(type, context, msg);
 }
 
+const LogMessage& ConsoleOutputModel::RunLog::at(qsizetype row) const
+{
+    return messages[(head + row) % messages.size()];
+}
+
+void ConsoleOutputModel::RunLog::append(LogMessage &&m)
+{
+    // grows until full, the ring only starts to wrap around after that
+    if ((qsizetype)messages.size() < MaxMessages) {
+        messages.push_back(std::move(m));
+        ++count;
+        return;
+    }
+    if (count == MaxMessages) {
+        dropOldest(1);
+        ++dropped;
+    }
+    messages[(head + count) % MaxMessages] = std::move(m);
+    ++count;
+}
+
+void ConsoleOutputModel::RunLog::dropOldest(qsizetype n)
+{
+    if (n >= count) {
+        messages.clear();
+        head = 0;
+        count = 0;
+        return;
+    }
+    for (auto i = 0; i < n; ++i) {
+        messages[(head + i) % messages.size()] = {};
+    }
+    head = (head + n) % messages.size();
+    count -= n;
+}
+
 ConsoleOutputModel::ConsoleOutputModel(QObject *parent)
     : QAbstractTableModel(parent)
 {
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushInterval);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ConsoleOutputModel::flush);
+
     sConsoleOutput = this;
     m_prevHandler = qInstallMessageHandler(messageHandler);
 }
@@ -66,6 +154,10 @@ ConsoleOutputModel::~ConsoleOutputModel()
 {
     qInstallMessageHandler(nullptr);
     sConsoleOutput = nullptr;
+
+    for (auto node = m_pending.exchange(nullptr); node;) {
+        delete std::exchange(node, node->next);
+    }
 }
 
 int ConsoleOutputModel::columnCount(const QModelIndex &parent) const
@@ -79,13 +171,14 @@ int ConsoleOutputModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid()) {
         return 0;
     }
-    return m_messages.size();
+    const auto log = currentLog();
+    return log ? (int)log->count : 0;
 }
 
 QVariant ConsoleOutputModel::data(const QModelIndex& index, int role) const
 {
+    const auto &msg = currentLog()->at(index.row());
     if (role == Qt::DisplayRole) {
-        const auto &msg = m_messages[index.row()];
         switch (index.column()) {
             case 0:
                 return i18n("%1:%2", msg.file, msg.line);
@@ -97,7 +190,7 @@ QVariant ConsoleOutputModel::data(const QModelIndex& index, int role) const
     }
 
     if (role == Qt::DecorationRole && index.column() == 0) {
-        switch (m_messages[index.row()].type) {
+        switch (msg.type) {
             case QtDebugMsg: return QIcon::fromTheme(QStringLiteral("dialog-question"));
             case QtInfoMsg: return QIcon::fromTheme(QStringLiteral("dialog-information"));
             case QtWarningMsg: return QIcon::fromTheme(QStringLiteral("dialog-warning"));
@@ -107,10 +200,10 @@ QVariant ConsoleOutputModel::data(const QModelIndex& index, int role) const
     }
 
     if (role == SourceFileRole) {
-        return m_messages[index.row()].file;
+        return msg.file;
     }
     if (role == SourceLineRole) {
-        return m_messages[index.row()].line;
+        return msg.line;
     }
 
     return {};
@@ -128,49 +221,136 @@ QVariant ConsoleOutputModel::headerData(int section, Qt::Orientation orientation
     return QAbstractTableModel::headerData(section, orientation, role);
 }
 
-void ConsoleOutputModel::clear()
+void ConsoleOutputModel::setRunId(quint64 runId)
 {
-    if (m_messages.empty()) {
+    if (m_runId == runId) {
         return;
     }
+    // anything still queued might be for the run we switch to
+    flush();
+
+    beginResetModel();
+    m_runId = runId;
+    endResetModel();
+    Q_EMIT droppedCountChanged();
+}
 
-    beginRemoveRows({}, 0, m_messages.size() - 1);
-    m_messages.clear();
-    endRemoveRows();
+qsizetype ConsoleOutputModel::droppedCount() const
+{
+    const auto log = currentLog();
+    return log ? log->dropped : 0;
+}
+
+void ConsoleOutputModel::setForwardMessages(bool forward)
+{
+    m_forwardMessages = forward;
 }
 
 void ConsoleOutputModel::handleMessage(QtMsgType type, const QMessageLogContext& context, const QString& msg)
 {
-    m_prevHandler(type, context, msg);
-    if (std::strcmp(context.category, "js") == 0) {
-        // script debug output
-        beginInsertRows({}, m_messages.size(), m_messages.size());
-        Message m;
-        m.msg = msg;
-        m.file = QString::fromUtf8(context.file);
-        m.function = QString::fromUtf8(context.function);
-        m.line = context.line;
-        m.type = type;
-        m_messages.push_back(std::move(m));
-        endInsertRows();
-    } else if (std::strcmp(context.category, "org.kde.kitinerary") == 0 && type == QtWarningMsg && msg.startsWith(QLatin1String("JS ERROR"))) {
-        // script engine errors
-        beginInsertRows({}, m_messages.size(), m_messages.size());
-        Message m;
-        const auto idx1 = msg.indexOf(QLatin1String("]:"), 11);
-        if (idx1 > 0) {
-            m.file = msg.mid(11, idx1 - 11);
-        }
-        const auto idx2 = msg.indexOf(QLatin1Char(':'), idx1 + 2);
-        if (idx2 > idx1) {
-            m.line = QStringView(msg).mid(idx1 + 2, idx2 - idx1 - 2).toInt();
-            m.msg = msg.mid(idx2 + 1);
+    LogMessage m;
+    if (!LogMessage::fromQtMessage(type, context, msg, m)) {
+        // not script output, so nothing the console shows
+        m_prevHandler(type, context, msg);
+        return;
+    }
+    if (m_forwardMessages) {
+        m_prevHandler(type, context, msg);
+    }
+    enqueue(std::move(m));
+}
+
+ConsoleOutputModel::RunLog& ConsoleOutputModel::runLog(quint64 runId)
+{
+    const auto it = m_logs.find(runId);
+    if (it != m_logs.end()) {
+        return it->second;
+    }
+
+    m_logOrder.push_back(runId);
+    if (m_logOrder.size() > MaxRunLogs) {
+        // never evict the shown run, that would need a model reset
+        const auto evictIt = m_logOrder.front() == m_runId ? std::next(m_logOrder.begin()) : m_logOrder.begin();
+        m_logs.erase(*evictIt);
+        m_logOrder.erase(evictIt);
+    }
+    return m_logs[runId];
+}
+
+const ConsoleOutputModel::RunLog* ConsoleOutputModel::currentLog() const
+{
+    const auto it = m_logs.find(m_runId);
+    return it != m_logs.end() ? &it->second : nullptr;
+}
+
+void ConsoleOutputModel::enqueue(LogMessage &&m)
+{
+    // called on whatever thread extraction runs on, possibly several at once
+    auto node = new PendingMessage{std::move(m), nullptr};
+    auto head = m_pending.load(std::memory_order_relaxed);
+    do {
+        node->next = head;
+    } while (!m_pending.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+
+    // only the message making the queue non-empty needs to schedule a flush
+    // node must not be touched anymore here, flush() might already have consumed it
+    if (!head) {
+        QMetaObject::invokeMethod(this, [this]() { m_flushTimer.start(); });
+    }
+}
+
+void ConsoleOutputModel::flush()
+{
+    auto node = m_pending.exchange(nullptr, std::memory_order_acquire);
+    if (!node) {
+        return;
+    }
+
+    // the queue is LIFO, restore the order in which messages were emitted
+    std::vector<LogMessage> batch;
+    while (node) {
+        batch.push_back(std::move(node->msg));
+        delete std::exchange(node, node->next);
+    }
+    std::reverse(batch.begin(), batch.end());
+
+    std::vector<LogMessage> current;
+    for (auto &m : batch) {
+        if (m.runId == m_runId) {
+            current.push_back(std::move(m));
         } else {
-            m.msg = msg;
+            runLog(m.runId).append(std::move(m));
         }
-        m.type = QtFatalMsg;
-        m_messages.push_back(std::move(m));
-        endInsertRows();
+    }
+    if (!current.empty()) {
+        flushCurrent(std::move(current));
+    }
+}
+
+void ConsoleOutputModel::flushCurrent(std::vector<LogMessage> &&batch)
+{
+    auto &log = runLog(m_runId);
+    const auto droppedBefore = log.dropped;
+
+    // drop the oldest rows to make room for the new batch
+    const auto overflow = std::min(log.count, log.count + (qsizetype)batch.size() - MaxMessages);
+    if (overflow > 0) {
+        beginRemoveRows({}, 0, (int)overflow - 1);
+        log.dropOldest(overflow);
+        log.dropped += overflow;
+        endRemoveRows();
+    }
+
+    const auto skip = std::max<qsizetype>(0, (qsizetype)batch.size() - MaxMessages);
+    log.dropped += skip;
+    beginInsertRows({}, (int)log.count, (int)(log.count + batch.size() - skip) - 1);
+    for (auto it = batch.begin() + skip; it != batch.end(); ++it) {
+        log.append(std::move(*it));
+    }
+    endInsertRows();
+
+    if (log.dropped != droppedBefore) {
+        Q_EMIT droppedCountChanged();
     }
 }
 
@@ -182,6 +362,24 @@ ConsoleOutputWidget::ConsoleOutputWidget(QWidget *parent)
 {
     ui->setupUi(this);
     ui->logView->setModel(m_model);
+    ui->droppedLabel->hide();
+
+    QSettings settings;
+    settings.beginGroup(QStringLiteral("ConsoleOutput"));
+    ui->forwardCheckBox->setChecked(settings.value(QStringLiteral("ForwardToStandardError"), true).toBool());
+    m_model->setForwardMessages(ui->forwardCheckBox->isChecked());
+    connect(ui->forwardCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        m_model->setForwardMessages(checked);
+        QSettings settings;
+        settings.beginGroup(QStringLiteral("ConsoleOutput"));
+        settings.setValue(QStringLiteral("ForwardToStandardError"), checked);
+    });
+
+    connect(m_model, &ConsoleOutputModel::droppedCountChanged, this, [this]() {
+        const auto count = m_model->droppedCount();
+        ui->droppedLabel->setText(i18np("1 older message dropped.", "%1 older messages dropped.", count));
+        ui->droppedLabel->setVisible(count > 0);
+    });
 
     connect(ui->logView, &QTreeView::activated, this, [this](const auto &idx) {
         if (!idx.isValid()) {
@@ -195,9 +393,9 @@ ConsoleOutputWidget::ConsoleOutputWidget(QWidget *parent)
 
 ConsoleOutputWidget::~ConsoleOutputWidget() = default;
 
-void ConsoleOutputWidget::clear()
+void ConsoleOutputWidget::setRunId(quint64 runId)
 {
-    m_model->clear();
+    m_model->setRunId(runId);
 }
 
 #include "consoleoutputwidget.moc"
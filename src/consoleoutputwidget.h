@@ -23,7 +23,8 @@ public:
     explicit ConsoleOutputWidget(QWidget *parent = nullptr);
     ~ConsoleOutputWidget();
 
-    void clear();
+    /** Shows the script output of extraction run @p runId, see LogScope. */
+    void setRunId(quint64 runId);
 
 Q_SIGNALS:
     void navigateToSource(const QString &file, int line);
@@ -6,52 +6,169 @@
 
 #include "documentmodel.h"
 
-#include <KItinerary/ExtractorDocumentNode>
-
 #include <KLocalizedString>
 
-#include <QIcon>
 #include <QMimeDatabase>
 
 using namespace KItinerary;
 
 DocumentModel::DocumentModel(QObject *parent)
-    : QStandardItemModel(parent)
+    : QAbstractItemModel(parent)
 {
 }
 
+DocumentModel::~DocumentModel() = default;
+
 void DocumentModel::setRootNode(const ExtractorDocumentNode &root)
 {
-    clear();
-    addNode(root, nullptr);
-    setHorizontalHeaderLabels({i18n("Type"), i18n("Context Time")});
+    beginResetModel();
+    m_root = std::make_unique<Item>();
+    m_root->populated = true;
+    if (!root.isNull()) {
+        auto item = std::make_unique<Item>();
+        item->node = root;
+        item->parent = m_root.get();
+        m_root->children.push_back(std::move(item));
+    }
+    endResetModel();
+}
+
+void DocumentModel::clear()
+{
+    beginResetModel();
+    m_root.reset();
+    endResetModel();
 }
 
-void DocumentModel::addNode(const ExtractorDocumentNode& node, QStandardItem *parent)
+QModelIndex DocumentModel::index(int row, int column, const QModelIndex &parent) const
 {
-    auto i1 = new QStandardItem;
-    i1->setText(node.mimeType());
-    i1->setData(QVariant::fromValue(node), Qt::UserRole);
-    i1->setFlags(i1->flags() & ~Qt::ItemIsEditable);
-    if (!node.location().isNull()) {
-        i1->setToolTip(i18n("Location: %1", node.location().toString()));
+    if (!hasIndex(row, column, parent)) {
+        return {};
     }
+    const auto parentItem = item(parent);
+    populate(parentItem);
+    return createIndex(row, column, parentItem->children[row].get());
+}
 
-    QMimeDatabase db;
-    const auto mt = db.mimeTypeForName(node.mimeType());
-    if (mt.isValid()) {
-        i1->setIcon(QIcon::fromTheme(mt.iconName(), QIcon::fromTheme(mt.genericIconName())));
+QModelIndex DocumentModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return {};
+    }
+    const auto parentItem = item(child)->parent;
+    if (!parentItem || parentItem == m_root.get()) {
+        return {};
+    }
+    return createIndex(parentItem->row, 0, parentItem);
+}
+
+int DocumentModel::rowCount(const QModelIndex &parent) const
+{
+    if (!m_root || parent.column() > 0) {
+        return 0;
+    }
+    const auto parentItem = item(parent);
+    populate(parentItem);
+    return (int)parentItem->children.size();
+}
+
+int DocumentModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+bool DocumentModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!m_root || parent.column() > 0) {
+        return false;
+    }
+    // avoids wrapping the child nodes just to decide whether to show an expansion marker
+    const auto parentItem = item(parent);
+    return parentItem->populated ? !parentItem->children.empty() : !parentItem->node.childNodes().empty();
+}
+
+QVariant DocumentModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
     }
 
-    auto i2 = new QStandardItem;
-    i2->setText(node.contextDateTime().toString(Qt::ISODate));
-    i2->setFlags(i1->flags() & ~Qt::ItemIsEditable);
+    const auto &node = item(index)->node;
+    switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+                case TypeColumn:
+                    return node.mimeType();
+                case ContextTimeColumn:
+                    return node.contextDateTime().toString(Qt::ISODate);
+            }
+            break;
+        case Qt::DecorationRole:
+            if (index.column() == TypeColumn) {
+                return icon(node.mimeType());
+            }
+            break;
+        case Qt::ToolTipRole:
+            if (!node.location().isNull()) {
+                return i18n("Location: %1", node.location().toString());
+            }
+            break;
+        case Qt::UserRole:
+            return QVariant::fromValue(node);
+    }
+    return {};
+}
+
+QVariant DocumentModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+            case TypeColumn:
+                return i18n("Type");
+            case ContextTimeColumn:
+                return i18n("Context Time");
+        }
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
 
-    if (parent)
-        parent->appendRow({i1, i2});
-    else
-        appendRow({i1, i2});
+DocumentModel::Item* DocumentModel::item(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Item*>(index.internalPointer()) : m_root.get();
+}
 
-    for (const auto &child : node.childNodes())
-        addNode(child, i1);
+void DocumentModel::populate(Item *item) const
+{
+    if (item->populated) {
+        return;
+    }
+    item->populated = true;
+
+    const auto &childNodes = item->node.childNodes();
+    item->children.reserve(childNodes.size());
+    for (const auto &childNode : childNodes) {
+        auto child = std::make_unique<Item>();
+        child->node = childNode;
+        child->parent = item;
+        child->row = (int)item->children.size();
+        item->children.push_back(std::move(child));
+    }
+}
+
+QIcon DocumentModel::icon(const QString &mimeType) const
+{
+    const auto it = m_iconCache.constFind(mimeType);
+    if (it != m_iconCache.constEnd()) {
+        return it.value();
+    }
+
+    QIcon icon;
+    QMimeDatabase db;
+    const auto mt = db.mimeTypeForName(mimeType);
+    if (mt.isValid()) {
+        icon = QIcon::fromTheme(mt.iconName(), QIcon::fromTheme(mt.genericIconName()));
+    }
+    m_iconCache.insert(mimeType, icon);
+    return icon;
 }
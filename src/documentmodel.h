@@ -7,23 +7,57 @@
 #ifndef DOCUMENTMODEL_H
 #define DOCUMENTMODEL_H
 
-# include <QStandardItemModel>
+#include <KItinerary/ExtractorDocumentNode>
 
-namespace KItinerary {
-class ExtractorDocumentNode;
-}
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QIcon>
 
-/** Extractor document node model. */
-class DocumentModel : public QStandardItemModel
+#include <memory>
+#include <vector>
+
+/** Extractor document node model.
+ *  Child nodes are only wrapped once their parent is expanded, so this stays cheap
+ *  for document trees with thousands of nodes.
+ */
+class DocumentModel : public QAbstractItemModel
 {
     Q_OBJECT
 public:
     explicit DocumentModel(QObject *parent = nullptr);
+    ~DocumentModel();
+
+    enum Column {
+        TypeColumn,
+        ContextTimeColumn,
+        ColumnCount
+    };
 
     void setRootNode(const KItinerary::ExtractorDocumentNode &root);
+    void clear();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    bool hasChildren(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
 private:
-    void addNode(const KItinerary::ExtractorDocumentNode &node, QStandardItem *parent);
+    struct Item {
+        KItinerary::ExtractorDocumentNode node;
+        Item *parent = nullptr;
+        int row = 0;
+        bool populated = false;
+        std::vector<std::unique_ptr<Item>> children;
+    };
+    Item* item(const QModelIndex &index) const;
+    void populate(Item *item) const;
+    QIcon icon(const QString &mimeType) const;
+
+    std::unique_ptr<Item> m_root; // invisible root, its only child is the actual root node
+    mutable QHash<QString, QIcon> m_iconCache;
 };
 
 #endif // DOCUMENTMODEL_H
@@ -6,13 +6,21 @@
 
 #include "dommodel.h"
 
-#include <KItinerary/HtmlDocument>
-
 #include <KColorScheme>
 #include <KLocalizedString>
 
+#include <QIcon>
+
+#include <algorithm>
+#include <iterator>
+
+// in characters, for the content snippets and tooltips of visible elements
+constexpr inline int ContentCacheSize = 4 * 1024 * 1024;
+constexpr inline int SnippetLength = 200;
+
 DOMModel::DOMModel(QObject *parent)
-    : QStandardItemModel(parent)
+    : QAbstractItemModel(parent)
+    , m_contentCache(ContentCacheSize)
 {
 }
 
@@ -20,14 +28,25 @@ DOMModel::~DOMModel() = default;
 
 void DOMModel::setDocument(KItinerary::HtmlDocument *doc)
 {
-    m_highlightNodeSet.clear();
-    clear();
+    beginResetModel();
+    m_highlightItems.clear();
+    m_contentCache.clear();
+    m_searchIndex.clear();
+    m_root.reset();
     m_document = doc;
-    if (!doc)
-        return;
-
-    addNode(nullptr, doc->root());
-    setHorizontalHeaderLabels({i18n("Element"), i18n("Content")});
+    if (doc) {
+        m_root = std::make_unique<Item>();
+        m_root->populated = true;
+        auto item = std::make_unique<Item>();
+        item->elem = doc->root();
+        item->parent = m_root.get();
+        m_root->children.push_back(std::move(item));
+    }
+    // re-apply the current search on the new document
+    const auto searchText = std::move(m_searchText);
+    m_searchText.clear();
+    search(searchText);
+    endResetModel();
 }
 
 KItinerary::HtmlDocument * DOMModel::document() const
@@ -35,50 +54,311 @@ KItinerary::HtmlDocument * DOMModel::document() const
     return m_document;
 }
 
+QModelIndex DOMModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return {};
+    }
+    const auto parentItem = item(parent);
+    populate(parentItem);
+    return createIndex(row, column, parentItem->children[row].get());
+}
+
+QModelIndex DOMModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return {};
+    }
+    const auto parentItem = item(child)->parent;
+    if (!parentItem || parentItem == m_root.get()) {
+        return {};
+    }
+    return createIndex(parentItem->row, 0, parentItem);
+}
+
+int DOMModel::rowCount(const QModelIndex &parent) const
+{
+    if (!m_root || parent.column() > 0) {
+        return 0;
+    }
+    const auto parentItem = item(parent);
+    populate(parentItem);
+    return (int)parentItem->children.size();
+}
+
+int DOMModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+bool DOMModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!m_root || parent.column() > 0) {
+        return false;
+    }
+    const auto parentItem = item(parent);
+    return parentItem->populated ? !parentItem->children.empty() : !parentItem->elem.firstChild().isNull();
+}
+
 QVariant DOMModel::data(const QModelIndex &index, int role) const
 {
-    if (role == Qt::BackgroundRole) {
-        const auto elem = index.sibling(index.row(), 0).data(Qt::UserRole).value<KItinerary::HtmlElement>();
-        if (std::find(m_highlightNodeSet.begin(), m_highlightNodeSet.end(), elem) != m_highlightNodeSet.end()) {
-            return KColorScheme(QPalette::Normal).background(KColorScheme::PositiveBackground);
-        }
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto it = item(index);
+    switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+                case ElementColumn:
+                    return it->elem.name();
+                case ContentColumn:
+                    return content(it).snippet;
+            }
+            break;
+        case Qt::ToolTipRole:
+            if (index.column() == ContentColumn) {
+                return content(it).full;
+            }
+            break;
+        case Qt::DecorationRole:
+            if (index.column() == ElementColumn) {
+                switch (kind(it)) {
+                    case ElementKind::Microdata:
+                        return QIcon::fromTheme(QLatin1String("comment-symbolic"));
+                    case ElementKind::Identified:
+                        return QIcon::fromTheme(QLatin1String("code-context"));
+                    default:
+                        break;
+                }
+            }
+            break;
+        case Qt::BackgroundRole:
+            if (it->highlighted) {
+                return KColorScheme(QPalette::Normal).background(KColorScheme::PositiveBackground);
+            }
+            break;
+        case Qt::UserRole:
+            return QVariant::fromValue(it->elem);
     }
+    return {};
+}
 
-    return QStandardItemModel::data(index, role);
+QVariant DOMModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+            case ElementColumn:
+                return i18n("Element");
+            case ContentColumn:
+                return i18n("Content");
+        }
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
 }
 
 void DOMModel::setHighlightNodeSet(const QVariantList &nodeSet)
 {
-    m_highlightNodeSet.clear();
-    m_highlightNodeSet.reserve(nodeSet.size());
-    std::transform(nodeSet.begin(), nodeSet.end(), std::back_inserter(m_highlightNodeSet), [](const QVariant &v) { return v.value<KItinerary::HtmlElement>(); });
+    for (auto it : m_highlightItems) {
+        it->highlighted = false;
+    }
+    m_highlightItems.clear();
+
+    // sorted by the row path from the root, ie. in document order
+    std::vector<std::pair<std::vector<int>, Item*>> items;
+    for (const auto &v : nodeSet) {
+        const auto it = findItem(v.value<KItinerary::HtmlElement>());
+        if (!it || it->highlighted) {
+            continue;
+        }
+        it->highlighted = true;
+        std::vector<int> path;
+        for (auto i = it; i != m_root.get(); i = i->parent) {
+            path.push_back(i->row);
+        }
+        std::reverse(path.begin(), path.end());
+        items.emplace_back(std::move(path), it);
+    }
+    std::sort(items.begin(), items.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+    m_highlightItems.reserve(items.size());
+    std::transform(items.begin(), items.end(), std::back_inserter(m_highlightItems), [](const auto &entry) { return entry.second; });
+}
+
+int DOMModel::highlightCount() const
+{
+    return (int)m_highlightItems.size();
 }
 
-void DOMModel::addNode(QStandardItem *parent, KItinerary::HtmlElement elem)
+QModelIndex DOMModel::highlightIndex(int i) const
 {
-    auto i1 = new QStandardItem;
-    i1->setText(elem.name());
-    i1->setData(QVariant::fromValue(elem), Qt::UserRole);
-    i1->setFlags(i1->flags() & ~Qt::ItemIsEditable);
+    if (i < 0 || i >= highlightCount()) {
+        return {};
+    }
+    const auto it = m_highlightItems[i];
+    return createIndex(it->row, 0, it);
+}
 
-    if (elem.hasAttribute(QLatin1String("itemtype")) || elem.hasAttribute(QLatin1String("itemprop")) || elem.hasAttribute(QLatin1String("itemscope"))) {
-        i1->setIcon(QIcon::fromTheme(QLatin1String("comment-symbolic")));
-    } else if (elem.hasAttribute(QLatin1String("id")) || elem.hasAttribute(QLatin1String("class"))) {
-        i1->setIcon(QIcon::fromTheme(QLatin1String("code-context")));
+void DOMModel::search(const QString &text)
+{
+    const auto needle = text.toCaseFolded();
+    if (!needle.isEmpty() && m_searchIndex.empty() && m_document) {
+        addSearchNode(m_document->root(), -1);
     }
 
-    auto i2 = new QStandardItem;
-    i2->setText(elem.content().left(200).replace(QLatin1Char('\n'), QLatin1Char(' ')));
-    i2->setToolTip(elem.content());
-    i2->setFlags(i2->flags() & ~Qt::ItemIsEditable);
+    if (needle.isEmpty()) {
+        m_searchMatches.clear();
+    } else if (!m_searchText.isEmpty() && needle.startsWith(m_searchText)) {
+        // refining the previous search, anything matching now has matched before as well
+        m_searchMatches.erase(std::remove_if(m_searchMatches.begin(), m_searchMatches.end(), [this, &needle](int node) {
+            return !m_searchIndex[node].text.contains(needle);
+        }), m_searchMatches.end());
+    } else {
+        m_searchMatches.clear();
+        for (int i = 0; i < (int)m_searchIndex.size(); ++i) {
+            if (m_searchIndex[i].text.contains(needle)) {
+                m_searchMatches.push_back(i);
+            }
+        }
+    }
+    m_searchText = needle;
 
-    if (parent)
-        parent->appendRow({i1, i2});
-    else
-        appendRow({i1, i2});
+    // elements only match on their own text, their ancestors are shown as the path to them
+    m_searchResults.assign(m_searchIndex.size(), false);
+    for (auto node : m_searchMatches) {
+        for (; node >= 0 && !m_searchResults[node]; node = m_searchIndex[node].parent) {
+            m_searchResults[node] = true;
+        }
+    }
+}
 
-    for (auto child = elem.firstChild(); !child.isNull(); child = child.nextSibling())
-        addNode(i1, child);
+bool DOMModel::isSearchResult(const QModelIndex &index) const
+{
+    return m_searchText.isEmpty() || (index.isValid() && m_searchResults[searchNode(item(index))]);
+}
+
+DOMModel::Item* DOMModel::item(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Item*>(index.internalPointer()) : m_root.get();
+}
+
+void DOMModel::populate(Item *item) const
+{
+    if (item->populated) {
+        return;
+    }
+    item->populated = true;
+
+    for (auto child = item->elem.firstChild(); !child.isNull(); child = child.nextSibling()) {
+        auto childItem = std::make_unique<Item>();
+        childItem->elem = child;
+        childItem->parent = item;
+        childItem->row = (int)item->children.size();
+        item->children.push_back(std::move(childItem));
+    }
+}
+
+DOMModel::Item* DOMModel::findItem(const KItinerary::HtmlElement &elem) const
+{
+    if (elem.isNull() || !m_root) {
+        return nullptr;
+    }
+
+    // HtmlElement has no identity we could hash, so descend along its ancestor chain instead
+    std::vector<KItinerary::HtmlElement> path;
+    for (auto e = elem; !e.isNull(); e = e.parent()) {
+        path.push_back(e);
+    }
+    auto it = m_root->children[0].get();
+    if (!(path.back() == it->elem)) {
+        return nullptr;
+    }
+
+    for (auto pathIt = std::next(path.rbegin()); pathIt != path.rend(); ++pathIt) {
+        populate(it);
+        const auto childIt = std::find_if(it->children.begin(), it->children.end(), [pathIt](const auto &child) { return child->elem == *pathIt; });
+        if (childIt == it->children.end()) {
+            return nullptr; // not an element, e.g. an attribute or text node
+        }
+        it = childIt->get();
+    }
+    return it;
+}
+
+DOMModel::ElementKind DOMModel::kind(Item *item) const
+{
+    if (item->kind == ElementKind::Unknown) {
+        const auto &elem = item->elem;
+        if (elem.hasAttribute(QLatin1String("itemtype")) || elem.hasAttribute(QLatin1String("itemprop")) || elem.hasAttribute(QLatin1String("itemscope"))) {
+            item->kind = ElementKind::Microdata;
+        } else if (elem.hasAttribute(QLatin1String("id")) || elem.hasAttribute(QLatin1String("class"))) {
+            item->kind = ElementKind::Identified;
+        } else {
+            item->kind = ElementKind::Plain;
+        }
+    }
+    return item->kind;
+}
+
+DOMModel::Content DOMModel::content(const Item *item) const
+{
+    if (const auto c = m_contentCache.object(item)) {
+        return *c;
+    }
+
+    Content c;
+    c.full = item->elem.content();
+    c.snippet = c.full.left(SnippetLength).replace(QLatin1Char('\n'), QLatin1Char(' '));
+    const auto cost = std::max<qsizetype>(1, c.full.size() + c.snippet.size());
+    if (cost <= m_contentCache.maxCost()) {
+        m_contentCache.insert(item, new Content(c), cost);
+    }
+    return c;
+}
+
+int DOMModel::addSearchNode(const KItinerary::HtmlElement &elem, int parent)
+{
+    const int node = (int)m_searchIndex.size();
+    m_searchIndex.emplace_back();
+    m_searchIndex[node].parent = parent;
+
+    // content() only has the text nodes directly below this element, not the text of the entire subtree
+    QString text = elem.name();
+    const auto attrs = elem.attributes();
+    for (const auto &attr : attrs) {
+        text += QLatin1Char('\n') + elem.attribute(attr);
+    }
+    text += QLatin1Char('\n') + elem.content();
+    m_searchIndex[node].text = text.toCaseFolded();
+
+    int previous = -1;
+    for (auto child = elem.firstChild(); !child.isNull(); child = child.nextSibling()) {
+        const auto childNode = addSearchNode(child, node);
+        if (previous >= 0) {
+            m_searchIndex[previous].nextSibling = childNode;
+        }
+        previous = childNode;
+    }
+    return node;
+}
+
+int DOMModel::searchNode(Item *item) const
+{
+    if (item->searchNode < 0) {
+        if (item->row > 0 && item->parent->children[item->row - 1]->searchNode >= 0) {
+            item->searchNode = m_searchIndex[item->parent->children[item->row - 1]->searchNode].nextSibling;
+        } else if (item->parent == m_root.get()) {
+            item->searchNode = 0;
+        } else {
+            // the search index is in pre-order, so the first child immediately follows its parent
+            auto node = searchNode(item->parent) + 1;
+            for (int i = 0; i < item->row; ++i) {
+                node = m_searchIndex[node].nextSibling;
+            }
+            item->searchNode = node;
+        }
+    }
+    return item->searchNode;
 }
 
 DOMFilterModel::DOMFilterModel(QObject *parent)
@@ -88,18 +368,26 @@ DOMFilterModel::DOMFilterModel(QObject *parent)
 
 DOMFilterModel::~DOMFilterModel() = default;
 
-bool DOMFilterModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
+void DOMFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
 {
-    for (int i = 0; i < sourceModel()->columnCount(source_parent); ++i) {
-        const auto str = sourceModel()->data(sourceModel()->index(source_row, i, source_parent), Qt::DisplayRole).toString();
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-        if (filterRegExp().indexIn(str) >= 0) {
-#else
-        if (str.contains(filterRegularExpression())) {
-#endif
-            return true;
-        }
+    m_domModel = qobject_cast<DOMModel*>(sourceModel);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+void DOMFilterModel::setSearchText(const QString &text)
+{
+    if (!m_domModel) {
+        return;
     }
+    m_domModel->search(text);
+    m_searchActive = !text.isEmpty();
+    invalidateFilter();
+}
 
-    return false;
+bool DOMFilterModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
+{
+    if (!m_searchActive || !m_domModel) {
+        return true;
+    }
+    return m_domModel->isSearchResult(m_domModel->index(source_row, 0, source_parent));
 }
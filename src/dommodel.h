@@ -7,39 +7,104 @@
 #ifndef DOMMODEL_H
 #define DOMMODEL_H
 
-#include <QStandardItemModel>
+#include <KItinerary/HtmlDocument>
+
+#include <QAbstractItemModel>
+#include <QCache>
 #include <QSortFilterProxyModel>
 
+#include <memory>
 #include <vector>
 
-namespace KItinerary {
-class HtmlDocument;
-class HtmlElement;
-}
-
-/** DOM model for a KItinerary::HtmlDocument. */
-class DOMModel : public QStandardItemModel
+/** DOM model for a KItinerary::HtmlDocument.
+ *  Elements are only wrapped once their parent is expanded, and their content is only
+ *  retrieved for rows that are actually shown.
+ */
+class DOMModel : public QAbstractItemModel
 {
     Q_OBJECT
 public:
     explicit DOMModel(QObject *parent = nullptr);
     ~DOMModel();
 
+    enum Column {
+        ElementColumn,
+        ContentColumn,
+        ColumnCount
+    };
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    bool hasChildren(const QModelIndex &parent = {}) const override;
     QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
     KItinerary::HtmlDocument *document() const;
     void setDocument(KItinerary::HtmlDocument *doc);
 
+    /** Highlights the elements in @p nodeSet, as returned by an XPath query. */
     void setHighlightNodeSet(const QVariantList &nodeSet);
+    /** Number of highlighted elements, in document order. */
+    int highlightCount() const;
+    QModelIndex highlightIndex(int i) const;
+
+    /** Searches element names, attribute values and content for @p text, case-insensitively.
+     *  The search index is built on the first search in a document.
+     *  Refining the previous search only looks at the previous matches.
+     */
+    void search(const QString &text);
+    /** Whether @p index matches the current search, or has a descendant that does. */
+    bool isSearchResult(const QModelIndex &index) const;
 
 private:
-    void addNode(QStandardItem *parent, KItinerary::HtmlElement elem);
+    enum class ElementKind : int8_t {
+        Unknown,
+        Plain,
+        Microdata,
+        Identified,
+    };
+    struct Item {
+        KItinerary::HtmlElement elem;
+        Item *parent = nullptr;
+        int row = 0;
+        int searchNode = -1; // position in m_searchIndex, once resolved
+        bool populated = false;
+        bool highlighted = false;
+        ElementKind kind = ElementKind::Unknown;
+        std::vector<std::unique_ptr<Item>> children;
+    };
+    struct Content {
+        QString snippet;
+        QString full;
+    };
+    /** Search index entry of an element, in pre-order. */
+    struct SearchNode {
+        int parent = -1;
+        int nextSibling = -1;
+        QString text; // case-folded, of this element only
+    };
+    Item* item(const QModelIndex &index) const;
+    void populate(Item *item) const;
+    Item* findItem(const KItinerary::HtmlElement &elem) const;
+    ElementKind kind(Item *item) const;
+    Content content(const Item *item) const;
+    int addSearchNode(const KItinerary::HtmlElement &elem, int parent);
+    int searchNode(Item *item) const;
 
     KItinerary::HtmlDocument *m_document = nullptr;
-    std::vector<KItinerary::HtmlElement> m_highlightNodeSet;
+    std::unique_ptr<Item> m_root; // invisible root, its only child is the document root element
+    mutable QCache<const Item*, Content> m_contentCache;
+    std::vector<Item*> m_highlightItems; // in document order
+
+    std::vector<SearchNode> m_searchIndex;
+    QString m_searchText;
+    std::vector<int> m_searchMatches;
+    std::vector<bool> m_searchResults; // matches and their ancestors
 };
 
-/** DOM multi-column aware filter model for searching. */
+/** DOM filter model for searching, using the search index of DOMModel. */
 class DOMFilterModel : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -47,8 +112,15 @@ public:
     explicit DOMFilterModel(QObject *parent = nullptr);
     ~DOMFilterModel();
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    void setSearchText(const QString &text);
+
 protected:
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+
+private:
+    DOMModel *m_domModel = nullptr;
+    bool m_searchActive = false;
 };
 
 #endif // DOMMODEL_H
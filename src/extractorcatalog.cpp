@@ -0,0 +1,288 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "extractorcatalog.h"
+
+#include <KLocalizedString>
+
+#include <QFileInfo>
+
+#include <algorithm>
+
+using namespace KItinerary;
+
+static bool isSameFilter(const ExtractorFilter &lhs, const ExtractorFilter &rhs)
+{
+    return lhs.mimeType() == rhs.mimeType() && lhs.scope() == rhs.scope() && lhs.fieldName() == rhs.fieldName() && lhs.pattern() == rhs.pattern();
+}
+
+static bool isSameEntry(const ExtractorCatalogModel::Entry &lhs, const ExtractorCatalogModel::Entry &rhs)
+{
+    return lhs.name == rhs.name && lhs.fileName == rhs.fileName && lhs.scriptFileName == rhs.scriptFileName
+        && lhs.scriptFunction == rhs.scriptFunction && lhs.mimeType == rhs.mimeType
+        && std::equal(lhs.filters.begin(), lhs.filters.end(), rhs.filters.begin(), rhs.filters.end(), isSameFilter);
+}
+
+static bool entryLessThan(const ExtractorCatalogModel::Entry &lhs, const ExtractorCatalogModel::Entry &rhs)
+{
+    // names should be unique, but nothing enforces that across search paths
+    return lhs.name == rhs.name ? lhs.fileName < rhs.fileName : lhs.name < rhs.name;
+}
+
+/** Subsequence match of @p needle in @p haystack, preferring consecutive characters and word starts.
+ *  Returns -1 if @p needle isn't contained in @p haystack at all.
+ */
+static int fuzzyScore(QStringView needle, QStringView haystack)
+{
+    if (const auto idx = haystack.indexOf(needle); idx >= 0) {
+        // plain substring matches always rank above scattered ones, prefixes above everything
+        return 4 * (int)needle.size() + (idx == 0 ? 2 : 1);
+    }
+
+    int score = 0;
+    qsizetype prev = -2;
+    qsizetype pos = 0;
+    for (const auto c : needle) {
+        pos = haystack.indexOf(c, pos);
+        if (pos < 0) {
+            return -1;
+        }
+        if (pos == prev + 1) {
+            score += 2;
+        } else if (pos == 0 || !haystack[pos - 1].isLetterOrNumber()) {
+            score += 1;
+        }
+        prev = pos++;
+    }
+    return score;
+}
+
+ExtractorCatalogModel::ExtractorCatalogModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+ExtractorCatalogModel::~ExtractorCatalogModel() = default;
+
+void ExtractorCatalogModel::reload(const ExtractorIndex &index)
+{
+    auto extractors = index.extractors();
+    std::vector<Entry> entries;
+    entries.reserve(extractors.size());
+    for (auto &ext : extractors) {
+        Entry e;
+        static_cast<ExtractorMetaData&>(e) = std::move(ext);
+        e.searchFields.reserve(3 + e.filters.size());
+        e.searchFields.push_back(e.name.toCaseFolded());
+        e.searchFields.push_back(QFileInfo(e.scriptFileName).fileName().toCaseFolded());
+        e.searchFields.push_back(e.scriptFunction.toCaseFolded());
+        for (const auto &filter : e.filters) {
+            e.searchFields.push_back(filter.pattern().toCaseFolded());
+        }
+        entries.push_back(std::move(e));
+    }
+    std::sort(entries.begin(), entries.end(), entryLessThan);
+
+    // the current search no longer applies to changed rows, see ExtractorCatalogFilterModel::setSearchText()
+    m_searchText.clear();
+    m_scores.clear();
+
+    // merge the new state into the existing one, both are sorted the same way
+    int row = 0;
+    auto it = entries.begin();
+    while (it != entries.end() || row < (int)m_entries.size()) {
+        if (row == (int)m_entries.size()) {
+            const auto count = (int)std::distance(it, entries.end());
+            beginInsertRows({}, row, row + count - 1);
+            std::move(it, entries.end(), std::back_inserter(m_entries));
+            endInsertRows();
+            break;
+        }
+        if (it == entries.end()) {
+            beginRemoveRows({}, row, (int)m_entries.size() - 1);
+            m_entries.erase(m_entries.begin() + row, m_entries.end());
+            endRemoveRows();
+            break;
+        }
+
+        if (entryLessThan(m_entries[row], *it)) {
+            beginRemoveRows({}, row, row);
+            m_entries.erase(m_entries.begin() + row);
+            endRemoveRows();
+        } else if (entryLessThan(*it, m_entries[row])) {
+            beginInsertRows({}, row, row);
+            m_entries.insert(m_entries.begin() + row, std::move(*it));
+            endInsertRows();
+            ++row;
+            ++it;
+        } else {
+            if (!isSameEntry(m_entries[row], *it)) {
+                m_entries[row] = std::move(*it);
+                Q_EMIT dataChanged(index(row, 0), index(row, ColumnCount - 1));
+            }
+            ++row;
+            ++it;
+        }
+    }
+
+    updateIndex();
+}
+
+int ExtractorCatalogModel::row(const QString &name) const
+{
+    return m_rowByName.value(name, -1);
+}
+
+const ExtractorCatalogModel::Entry& ExtractorCatalogModel::entry(int row) const
+{
+    return m_entries[row];
+}
+
+int ExtractorCatalogModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+int ExtractorCatalogModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return (int)m_entries.size();
+}
+
+QVariant ExtractorCatalogModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto &e = m_entries[index.row()];
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+            switch (index.column()) {
+                case NameColumn:
+                    return e.name;
+                case DetailsColumn:
+                    return i18n("%1 in %2", e.scriptFunction, QFileInfo(e.scriptFileName).fileName());
+            }
+            break;
+        case Qt::ToolTipRole:
+            return i18n("%1 (%2)", e.fileName, e.mimeType);
+    }
+    return {};
+}
+
+QVariant ExtractorCatalogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+            case NameColumn:
+                return i18n("Extractor");
+            case DetailsColumn:
+                return i18n("Function");
+        }
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void ExtractorCatalogModel::search(const QString &text)
+{
+    const auto needle = text.toCaseFolded();
+    const auto refine = !m_searchText.isEmpty() && needle.startsWith(m_searchText) && m_scores.size() == m_entries.size();
+    m_searchText = needle;
+
+    if (needle.isEmpty()) {
+        m_scores.clear();
+        return;
+    }
+    if (!refine) {
+        m_scores.assign(m_entries.size(), 0);
+    }
+    for (int i = 0; i < (int)m_entries.size(); ++i) {
+        // when refining the previous search, anything matching now has matched before as well
+        if (m_scores[i] >= 0) {
+            m_scores[i] = score(i);
+        }
+    }
+}
+
+bool ExtractorCatalogModel::isSearchResult(int row) const
+{
+    return m_scores.empty() || m_scores[row] >= 0;
+}
+
+int ExtractorCatalogModel::searchScore(int row) const
+{
+    return m_scores.empty() ? 0 : m_scores[row];
+}
+
+void ExtractorCatalogModel::updateIndex()
+{
+    m_rowByName.clear();
+    m_rowByName.reserve(m_entries.size());
+    for (int i = (int)m_entries.size() - 1; i >= 0; --i) {
+        m_rowByName.insert(m_entries[i].name, i);
+    }
+}
+
+int ExtractorCatalogModel::score(int row) const
+{
+    int best = -1;
+    const auto &fields = m_entries[row].searchFields;
+    for (qsizetype i = 0; i < fields.size(); ++i) {
+        auto s = fuzzyScore(m_searchText, fields[i]);
+        // matches on the name beat equally good ones on anything else
+        if (s >= 0 && i == 0) {
+            s = 2 * s + 1;
+        }
+        best = std::max(best, s);
+    }
+    return best;
+}
+
+
+ExtractorCatalogFilterModel::ExtractorCatalogFilterModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    sort(0, Qt::AscendingOrder);
+}
+
+ExtractorCatalogFilterModel::~ExtractorCatalogFilterModel() = default;
+
+void ExtractorCatalogFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    m_catalog = qobject_cast<ExtractorCatalogModel*>(sourceModel);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+void ExtractorCatalogFilterModel::setSearchText(const QString &text)
+{
+    if (!m_catalog) {
+        return;
+    }
+    m_catalog->search(text);
+    invalidate();
+}
+
+bool ExtractorCatalogFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+    Q_UNUSED(source_parent);
+    return !m_catalog || m_catalog->isSearchResult(source_row);
+}
+
+bool ExtractorCatalogFilterModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
+{
+    if (!m_catalog) {
+        return QSortFilterProxyModel::lessThan(source_left, source_right);
+    }
+    // best match first, otherwise keep the name order of the catalog
+    const auto lhsScore = m_catalog->searchScore(source_left.row());
+    const auto rhsScore = m_catalog->searchScore(source_right.row());
+    return lhsScore == rhsScore ? source_left.row() < source_right.row() : lhsScore > rhsScore;
+}
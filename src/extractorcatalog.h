@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef EXTRACTORCATALOG_H
+#define EXTRACTORCATALOG_H
+
+#include "extractorindex.h"
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSortFilterProxyModel>
+
+#include <vector>
+
+/** Meta data of all script extractors in the extractor repository.
+ *  This is a snapshot of the ExtractorIndex taken on reload(), so it can be browsed
+ *  and searched without going through the repository (and its string based lookup) each time.
+ */
+class ExtractorCatalogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit ExtractorCatalogModel(QObject *parent = nullptr);
+    ~ExtractorCatalogModel();
+
+    enum Column {
+        NameColumn,
+        DetailsColumn,
+        ColumnCount
+    };
+
+    class Entry : public ExtractorMetaData {
+    public:
+        // case-folded name, script file name, function and filter patterns, for searching
+        QStringList searchFields;
+    };
+
+    /** Updates the catalog to the current state of @p index.
+     *  Only rows of added, removed or changed extractors are touched, so views
+     *  keep their state across repository reloads. This resets the search.
+     */
+    void reload(const ExtractorIndex &index);
+
+    /** Row of extractor @p name, -1 if there is no such extractor. */
+    int row(const QString &name) const;
+    const Entry& entry(int row) const;
+
+    int columnCount(const QModelIndex &parent = {}) const override;
+    int rowCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    /** Fuzzy matches @p text against the extractor meta data, see isSearchResult() and searchScore(). */
+    void search(const QString &text);
+    bool isSearchResult(int row) const;
+    /** Higher is better, only valid for search results. */
+    int searchScore(int row) const;
+
+private:
+    void updateIndex();
+    int score(int row) const;
+
+    std::vector<Entry> m_entries; // sorted by name
+    QHash<QString, int> m_rowByName;
+
+    QString m_searchText;
+    std::vector<int> m_scores; // -1 for rows not matching the current search
+};
+
+/** Filters and ranks the extractor catalog by a fuzzy search. */
+class ExtractorCatalogFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit ExtractorCatalogFilterModel(QObject *parent = nullptr);
+    ~ExtractorCatalogFilterModel();
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    void setSearchText(const QString &text);
+
+protected:
+    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+    bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const override;
+
+private:
+    ExtractorCatalogModel *m_catalog = nullptr;
+};
+
+#endif // EXTRACTORCATALOG_H
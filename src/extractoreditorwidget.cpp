@@ -7,6 +7,9 @@
 #include "extractoreditorwidget.h"
 #include "ui_extractoreditorwidget.h"
 
+#include "extractorcatalog.h"
+#include "extractorrunner.h"
+#include "filterprofiler.h"
 #include "metaenumcombobox.h"
 
 #include <KItinerary/ExtractorFilter>
@@ -18,13 +21,17 @@
 #include <KTextEditor/View>
 
 #include <KActionCollection>
+#include <KColorScheme>
 #include <KLocalizedString>
 
 #include <QAbstractTableModel>
+#include <QCompleter>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QFileDialog>
+#include <QFileSystemWatcher>
+#include <QHeaderView>
 #include <QItemEditorFactory>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -32,11 +39,24 @@
 #include <QMessageBox>
 #include <QMetaEnum>
 #include <QSettings>
+#include <QStandardItemModel>
 #include <QStandardPaths>
 #include <QStyledItemDelegate>
+#include <QTimer>
+#include <QTreeView>
+
+#include <algorithm>
 
 using namespace KItinerary;
 
+// filters taking longer than this on the entire document tree are highlighted
+constexpr inline qint64 SlowFilterThreshold = 10'000'000; // nsecs
+
+static QString formatMs(qint64 ns)
+{
+    return QString::number(ns / 1'000'000.0, 'f', 3);
+}
+
 class ExtractorFilterModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -200,6 +220,11 @@ ExtractorEditorWidget::ExtractorEditorWidget(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::ExtractorEditorWidget)
     , m_filterModel(new ExtractorFilterModel(this))
+    , m_catalog(new ExtractorCatalogModel(this))
+    , m_catalogFilter(new ExtractorCatalogFilterModel(this))
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_watchTimer(new QTimer(this))
+    , m_filterProfileModel(new QStandardItemModel(this))
 {
     ui->setupUi(this);
     ui->inputType->addItems({
@@ -218,39 +243,62 @@ ExtractorEditorWidget::ExtractorEditorWidget(QWidget *parent)
         QStringLiteral("text/plain")
     });
     ui->filterView->setModel(m_filterModel);
+    ui->filterProfileView->setModel(m_filterProfileModel);
+    ui->filterProfileView->hide();
 
     QSettings settings;
     settings.beginGroup(QLatin1String("Extractor Repository"));
     ExtractorRepository repo;
     repo.setAdditionalSearchPaths(settings.value(QLatin1String("SearchPaths"), QStringList()).toStringList());
-    repo.reload();
+    if (!repo.additionalSearchPaths().isEmpty()) {
+        // the repository has only loaded the default search paths on construction
+        repo.reload();
+    }
+    // the repository has parsed everything already, the index only needs to take over what changed since last time
+    if (m_index.check(repo.additionalSearchPaths()).hasChanges()) {
+        m_index.update(repo);
+    }
 
-    connect(ui->extractorCombobox, qOverload<int>(&QComboBox::currentIndexChanged), this, [this]() {
-        ExtractorRepository repo;
-        const auto extId = ui->extractorCombobox->currentText();
-        const auto extractor = dynamic_cast<const ScriptExtractor*>(repo.extractorByName(extId));
-        if (!extractor) {
-            return;
-        }
-        ui->scriptEdit->setText(extractor->scriptFileName());
-        ui->functionEdit->setText(extractor->scriptFunction());
-        ui->inputType->setCurrentIndex(ui->inputType->findText(extractor->mimeType()));
-        m_filterModel->setFilters(extractor->filters());
-        m_scriptDoc->openUrl(QUrl::fromLocalFile(extractor->scriptFileName()));
-
-        QFileInfo scriptFi(extractor->fileName());
-        m_scriptDoc->setReadWrite(scriptFi.isWritable());
-        QFileInfo metaFi(extractor->fileName());
-        setMetaDataReadOnly(!metaFi.isWritable());
-        validateInput();
-    });
+    // the combo box lists all extractors by name, typing into it offers a fuzzy search over all their meta data
+    ui->extractorCombobox->setModel(m_catalog);
+    ui->extractorCombobox->setEditable(true);
+    ui->extractorCombobox->setInsertPolicy(QComboBox::NoInsert);
+    m_catalogFilter->setSourceModel(m_catalog);
+    auto completer = new QCompleter(m_catalogFilter, this);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    auto popup = new QTreeView;
+    popup->setRootIsDecorated(false);
+    popup->setHeaderHidden(true);
+    popup->setUniformRowHeights(true);
+    completer->setPopup(popup);
+    ui->extractorCombobox->setCompleter(completer);
+    connect(ui->extractorCombobox->lineEdit(), &QLineEdit::textEdited, m_catalogFilter, &ExtractorCatalogFilterModel::setSearchText);
+    connect(completer, qOverload<const QString&>(&QCompleter::activated), this, &ExtractorEditorWidget::showExtractor);
+    connect(ui->extractorCombobox, qOverload<int>(&QComboBox::currentIndexChanged), this, &ExtractorEditorWidget::loadExtractor);
 
     auto editor = KTextEditor::Editor::instance();
     m_scriptDoc = editor->createDocument(nullptr);
     m_scriptDoc->setHighlightingMode(QStringLiteral("JavaScript"));
     m_scriptView = m_scriptDoc->createView(nullptr);
     ui->topLayout->addWidget(m_scriptView);
-    reloadExtractors();
+    reloadCatalog();
+
+    // editors save in several steps, and checkouts touch many files at once, so collect changes for a moment
+    m_watchTimer->setSingleShot(true);
+    m_watchTimer->setInterval(std::chrono::milliseconds(500));
+    connect(m_watchTimer, &QTimer::timeout, this, &ExtractorEditorWidget::processFileChanges);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_watchTimer, qOverload<>(&QTimer::start));
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &fileName) {
+        if (fileName.endsWith(QLatin1String(".js"))) {
+            m_changedScripts.insert(fileName);
+        }
+        m_watchTimer->start();
+    });
+    connect(m_scriptDoc, &KTextEditor::Document::documentSavedOrUploaded, this, [this](KTextEditor::Document *doc) {
+        const auto fileName = doc->url().toLocalFile();
+        m_savedScripts.insert(fileName, QFileInfo(fileName).lastModified().toMSecsSinceEpoch());
+    });
+    updateWatchedFiles();
 
     connect(m_scriptDoc, &KTextEditor::Document::modifiedChanged, this, [this]() {
         if (!m_scriptDoc->isModified()) { // approximation for "document has been saved"
@@ -274,6 +322,12 @@ ExtractorEditorWidget::ExtractorEditorWidget(QWidget *parent)
     connect(m_filterModel, &ExtractorFilterModel::dataChanged, this, &ExtractorEditorWidget::validateInput);
     connect(ui->filterView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &ExtractorEditorWidget::validateInput);
 
+    connect(ui->profileFiltersButton, &QToolButton::clicked, this, &ExtractorEditorWidget::profileFilters);
+    // results for other filters are only misleading
+    connect(m_filterModel, &ExtractorFilterModel::modelReset, this, &ExtractorEditorWidget::clearFilterProfile);
+    connect(m_filterModel, &ExtractorFilterModel::dataChanged, this, &ExtractorEditorWidget::clearFilterProfile);
+    connect(m_filterModel, &ExtractorFilterModel::rowsRemoved, this, &ExtractorEditorWidget::clearFilterProfile);
+
     auto factory = new QItemEditorFactory;
     factory->registerEditor(qMetaTypeId<ExtractorFilter::Scope>(), new QStandardItemEditorCreator<MetaEnumComboBox>());
     qobject_cast<QStyledItemDelegate*>(ui->filterView->itemDelegate())->setItemEditorFactory(factory);
@@ -290,25 +344,169 @@ void ExtractorEditorWidget::registerActions(KActionCollection *ac)
     ac->addAction(QStringLiteral("file_save_extractor"), ui->actionFileSaveExtractor);
 }
 
-void ExtractorEditorWidget::reloadExtractors()
+void ExtractorEditorWidget::setRunner(ExtractorRunner *runner)
+{
+    m_runner = runner;
+}
+
+void ExtractorEditorWidget::setCurrentRun(const std::shared_ptr<ExtractorRun> &run)
+{
+    m_currentRun = run;
+    clearFilterProfile();
+    validateInput();
+}
+
+QString ExtractorEditorWidget::reloadRepository()
+{
+    const auto stats = updateRepository(nullptr, nullptr, false);
+    if (!stats.hasChanges()) {
+        return i18n("Extractor repository unchanged, %1 files checked.", stats.unchanged);
+    }
+    return i18n("Extractor repository reloaded, %1 files parsed (%2 changed, %3 removed).", m_index.files().size(), stats.changed, stats.removed);
+}
+
+ExtractorIndex::Stats ExtractorEditorWidget::updateRepository(std::vector<ExtractorMetaData> *previousExtractors, std::vector<ExtractorMetaData> *changedExtractors, bool force)
 {
-    ui->extractorCombobox->clear();
     ExtractorRepository repo;
-    for (const auto &ext : repo.extractors()) {
-        if (dynamic_cast<ScriptExtractor*>(ext.get())) {
-            ui->extractorCombobox->addItem(ext->name());
+    const auto stats = m_index.check(repo.additionalSearchPaths());
+    if (!stats.hasChanges() && !force) {
+        return stats;
+    }
+
+    // ExtractorRepository can't be fed from the index, so if anything changed it has to parse everything again
+    Q_EMIT repositoryAboutToReload();
+    repo.reload();
+    m_index.update(repo);
+    // what was in the changed files before as well as what is in there now
+    if (previousExtractors) {
+        appendExtractorsInFiles(stats.changedFiles, *previousExtractors);
+    }
+    reloadCatalog();
+    if (changedExtractors) {
+        appendExtractorsInFiles(stats.changedFiles, *changedExtractors);
+    }
+    updateWatchedFiles();
+    return stats;
+}
+
+void ExtractorEditorWidget::appendExtractorsInFiles(const QStringList &fileNames, std::vector<ExtractorMetaData> &extractors) const
+{
+    for (int i = 0; i < m_catalog->rowCount(); ++i) {
+        const auto &entry = m_catalog->entry(i);
+        if (fileNames.contains(entry.fileName)) {
+            extractors.push_back(entry);
+        }
+    }
+}
+
+void ExtractorEditorWidget::reloadCatalog()
+{
+    m_catalog->reload(m_index);
+    m_catalogFilter->setSearchText({});
+}
+
+void ExtractorEditorWidget::updateWatchedFiles()
+{
+    ExtractorRepository repo;
+    QSet<QString> paths;
+    const auto searchPaths = ExtractorIndex::searchPaths(repo.additionalSearchPaths());
+    for (const auto &path : searchPaths) {
+        paths.insert(path);
+    }
+    const auto metaFiles = m_index.files();
+    for (const auto &fileName : metaFiles) {
+        paths.insert(fileName);
+    }
+    for (int i = 0; i < m_catalog->rowCount(); ++i) {
+        paths.insert(m_catalog->entry(i).scriptFileName);
+    }
+
+    // built-in extractors are compiled in and can't change, files replaced on saving drop out of the watch list
+    const auto watchedPaths = m_watcher->files() + m_watcher->directories();
+    const QSet<QString> watched(watchedPaths.begin(), watchedPaths.end());
+    QStringList added;
+    for (const auto &path : std::as_const(paths)) {
+        if (!path.startsWith(QLatin1Char(':')) && !watched.contains(path) && QFileInfo::exists(path)) {
+            added.push_back(path);
+        }
+    }
+    QStringList removed;
+    for (const auto &path : watchedPaths) {
+        if (!paths.contains(path)) {
+            removed.push_back(path);
         }
     }
+    if (!removed.isEmpty()) {
+        m_watcher->removePaths(removed);
+    }
+    if (!added.isEmpty()) {
+        m_watcher->addPaths(added);
+    }
+}
+
+void ExtractorEditorWidget::processFileChanges()
+{
+    // meta data changes need a repository reload, the index tells us which files those are
+    std::vector<ExtractorMetaData> previousMetaData;
+    std::vector<ExtractorMetaData> metaDataChanges;
+    updateRepository(&previousMetaData, &metaDataChanges, false);
+    if (!previousMetaData.empty() || !metaDataChanges.empty()) {
+        Q_EMIT extractorsModified(metaDataChanges, previousMetaData, true);
+    }
+
+    // script changes only need the extractors using them to run again
+    std::vector<ExtractorMetaData> scriptChanges;
+    for (const auto &fileName : std::as_const(m_changedScripts)) {
+        const auto savedIt = m_savedScripts.constFind(fileName);
+        if (savedIt != m_savedScripts.constEnd() && savedIt.value() == QFileInfo(fileName).lastModified().toMSecsSinceEpoch()) {
+            continue;
+        }
+        for (int i = 0; i < m_catalog->rowCount(); ++i) {
+            if (m_catalog->entry(i).scriptFileName == fileName) {
+                scriptChanges.push_back(m_catalog->entry(i));
+            }
+        }
+    }
+    m_changedScripts.clear();
+    if (!scriptChanges.empty()) {
+        Q_EMIT extractorsModified(scriptChanges, {}, false);
+    }
+
+    updateWatchedFiles();
 }
 
 void ExtractorEditorWidget::showExtractor(const QString &extractorId)
 {
-    const auto idx = ui->extractorCombobox->findText(extractorId);
+    const auto idx = m_catalog->row(extractorId);
     if (idx >= 0 && idx != ui->extractorCombobox->currentIndex()) {
         ui->extractorCombobox->setCurrentIndex(idx);
     }
 }
 
+void ExtractorEditorWidget::loadExtractor(int row)
+{
+    if (row < 0) {
+        return;
+    }
+
+    const auto &extractor = m_catalog->entry(row);
+    ui->scriptEdit->setText(extractor.scriptFileName);
+    ui->functionEdit->setText(extractor.scriptFunction);
+    ui->inputType->setCurrentIndex(ui->inputType->findText(extractor.mimeType));
+    m_filterModel->setFilters(extractor.filters);
+    // many extractors share one script file, no need to load that again
+    const auto scriptUrl = QUrl::fromLocalFile(extractor.scriptFileName);
+    if (m_scriptDoc->url() != scriptUrl) {
+        m_scriptDoc->openUrl(scriptUrl);
+    }
+
+    QFileInfo scriptFi(extractor.fileName);
+    m_scriptDoc->setReadWrite(scriptFi.isWritable());
+    QFileInfo metaFi(extractor.fileName);
+    setMetaDataReadOnly(!metaFi.isWritable());
+    validateInput();
+}
+
 void ExtractorEditorWidget::navigateToSource(const QString &fileName, int line)
 {
     // TODO find the extractor this file belongs to and select it?
@@ -330,8 +528,12 @@ void ExtractorEditorWidget::setMetaDataReadOnly(bool readOnly)
 
 void ExtractorEditorWidget::save()
 {
+    const auto row = ui->extractorCombobox->currentIndex();
+    if (row < 0) {
+        return;
+    }
     ExtractorRepository repo;
-    const auto extId = ui->extractorCombobox->currentText();
+    const auto extId = m_catalog->entry(row).name;
     auto extractor = const_cast<ScriptExtractor*>(dynamic_cast<const ScriptExtractor*>(repo.extractorByName(extId)));
     Q_ASSERT(extractor);
 
@@ -351,7 +553,8 @@ void ExtractorEditorWidget::save()
     f.close();
     m_scriptDoc->save();
 
-    repo.reload();
+    // file attributes can't be relied on to notice our own write, e.g. with coarse timestamps and an unchanged size
+    updateRepository(nullptr, nullptr, true);
 }
 
 void ExtractorEditorWidget::create()
@@ -401,8 +604,7 @@ function main(content) {
     metaFile.write((json.isArray() ? QJsonDocument(json.toArray()) : QJsonDocument(json.toObject())).toJson());
     metaFile.close();
 
-    repo.reload();
-    reloadExtractors();
+    updateRepository(nullptr, nullptr, true);
     showExtractor(metaFi.baseName());
 }
 
@@ -411,6 +613,77 @@ void ExtractorEditorWidget::validateInput()
     bool valid = !ui->scriptEdit->text().isEmpty() && !ui->functionEdit->text().isEmpty();
     ui->actionFileSaveExtractor->setEnabled(valid);
     ui->removeFilterButton->setEnabled(m_filterModel->rowCount() > 1 && !m_filterModel->isReadOnly());
+    ui->profileFiltersButton->setEnabled(m_runner && m_currentRun && m_currentRun->engine && m_filterModel->rowCount() > 0);
+}
+
+void ExtractorEditorWidget::profileFilters()
+{
+    if (!m_runner || !m_currentRun) {
+        return;
+    }
+
+    const auto generation = ++m_profileGeneration;
+    m_profiledFilters = m_filterModel->filters();
+    // the document tree must only be touched on the thread it belongs to
+    m_runner->post([this, run = m_currentRun, filters = m_profiledFilters, generation]() {
+        if (!run->engine) {
+            return; // taken over by a re-run in the meantime
+        }
+        auto profiles = FilterProfile::profile(filters, run->engine->rootDocumentNode());
+        QMetaObject::invokeMethod(this, [this, profiles = std::move(profiles), generation]() {
+            if (generation == m_profileGeneration) {
+                showFilterProfile(profiles);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ExtractorEditorWidget::showFilterProfile(const std::vector<FilterProfile> &profiles)
+{
+    m_filterProfileModel->clear();
+    m_filterProfileModel->setHorizontalHeaderLabels({i18n("Filter"), i18n("Matches"), i18n("Total (ms)"), i18n("Max (ms)"), i18n("Slowest Node")});
+
+    const auto scopeEnum = QMetaEnum::fromType<ExtractorFilter::Scope>();
+    for (std::size_t i = 0; i < profiles.size() && i < m_profiledFilters.size(); ++i) {
+        const auto &filter = m_profiledFilters[i];
+        const auto &profile = profiles[i];
+
+        auto filterItem = new QStandardItem(i18n("%1 %2 (%3): %4", filter.mimeType(), filter.fieldName(),
+                                                 QString::fromUtf8(scopeEnum.valueToKey(filter.scope())), filter.pattern()));
+        filterItem->setToolTip(i18np("Evaluated on 1 node.", "Evaluated on %1 nodes.", profile.evaluatedNodes));
+        QList<QStandardItem*> row({
+            filterItem,
+            new QStandardItem(QString::number(profile.matches.size())),
+            new QStandardItem(formatMs(profile.totalTime)),
+            new QStandardItem(formatMs(profile.maxTime)),
+            new QStandardItem(profile.slowestNodePath),
+        });
+        if (profile.totalTime > SlowFilterThreshold) {
+            const auto brush = KColorScheme(QPalette::Normal).background(KColorScheme::NegativeBackground);
+            for (auto item : row) {
+                item->setBackground(brush);
+            }
+        }
+
+        for (const auto &match : profile.matches) {
+            auto matchItem = new QStandardItem(i18n("%1 (%2)", match.nodePath, match.mimeType));
+            if (match.triggerPath != match.nodePath) {
+                matchItem->setToolTip(i18n("Matched when evaluating node %1.", match.triggerPath));
+            }
+            filterItem->appendRow(matchItem);
+        }
+        m_filterProfileModel->appendRow(row);
+    }
+
+    ui->filterProfileView->show();
+    ui->filterProfileView->header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+void ExtractorEditorWidget::clearFilterProfile()
+{
+    ++m_profileGeneration;
+    m_filterProfileModel->clear();
+    ui->filterProfileView->hide();
 }
 
 #include "extractoreditorwidget.moc"
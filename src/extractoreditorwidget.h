@@ -7,9 +7,14 @@
 #ifndef EXTRACTOREDITORWIDGET_H
 #define EXTRACTOREDITORWIDGET_H
 
+#include "extractorindex.h"
+
+#include <QHash>
+#include <QSet>
 #include <QWidget>
 
 #include <memory>
+#include <vector>
 
 namespace KTextEditor {
 class Document;
@@ -18,8 +23,17 @@ class View;
 
 class KActionCollection;
 
+class QFileSystemWatcher;
+class QStandardItemModel;
+class QTimer;
+
 class Ui_ExtractorEditorWidget;
+class ExtractorCatalogFilterModel;
+class ExtractorCatalogModel;
 class ExtractorFilterModel;
+class ExtractorRun;
+class ExtractorRunner;
+class FilterProfile;
 
 class ExtractorEditorWidget : public QWidget
 {
@@ -28,22 +42,63 @@ public:
     explicit ExtractorEditorWidget(QWidget *parent = nullptr);
     ~ExtractorEditorWidget();
     void registerActions(KActionCollection *ac);
+    /** Runner owning the document trees filters are profiled on. */
+    void setRunner(ExtractorRunner *runner);
+    /** The run whose document tree filters are profiled on. */
+    void setCurrentRun(const std::shared_ptr<ExtractorRun> &run);
 
     void showExtractor(const QString &extractorId);
     void navigateToSource(const QString &fileName, int line);
-    void reloadExtractors();
+    /** Reloads the extractor repository if any extractor meta data changed on disk.
+     *  Returns a summary of what the repository had to parse, for display.
+     */
+    QString reloadRepository();
 
 Q_SIGNALS:
     void extractorChanged();
+    /** Emitted before the extractor repository is reloaded, ie. before global engine state changes. */
+    void repositoryAboutToReload();
+    /** Emitted when files of @p extractors changed outside of this editor.
+     *  @p metaDataChanged is @c false if only their scripts changed, which doesn't need a repository reload.
+     *  Otherwise @p previousExtractors are the extractors the changed meta data files defined before the reload.
+     */
+    void extractorsModified(const std::vector<ExtractorMetaData> &extractors, const std::vector<ExtractorMetaData> &previousExtractors, bool metaDataChanged);
 
 private:
+    /** Reloads the extractor repository if any meta data file changed, or @p force is set.
+     *  The extractors in changed files before and after the reload are added to @p previousExtractors and @p changedExtractors.
+     */
+    ExtractorIndex::Stats updateRepository(std::vector<ExtractorMetaData> *previousExtractors, std::vector<ExtractorMetaData> *changedExtractors, bool force);
+    void appendExtractorsInFiles(const QStringList &fileNames, std::vector<ExtractorMetaData> &extractors) const;
+    void reloadCatalog();
+    void updateWatchedFiles();
+    void processFileChanges();
+    void loadExtractor(int row);
     void setMetaDataReadOnly(bool readOnly);
     void save();
     void create();
     void validateInput();
+    void profileFilters();
+    void showFilterProfile(const std::vector<FilterProfile> &profiles);
+    void clearFilterProfile();
 
     std::unique_ptr<Ui_ExtractorEditorWidget> ui;
     ExtractorFilterModel *m_filterModel = nullptr;
+    ExtractorCatalogModel *m_catalog = nullptr;
+    ExtractorCatalogFilterModel *m_catalogFilter = nullptr;
+    ExtractorIndex m_index;
+
+    QFileSystemWatcher *m_watcher = nullptr;
+    QTimer *m_watchTimer = nullptr;
+    QSet<QString> m_changedScripts;
+    // modification times of scripts last saved by us, so we don't react to our own changes
+    QHash<QString, qint64> m_savedScripts;
+
+    ExtractorRunner *m_runner = nullptr;
+    std::shared_ptr<ExtractorRun> m_currentRun;
+    QStandardItemModel *m_filterProfileModel = nullptr;
+    std::vector<KItinerary::ExtractorFilter> m_profiledFilters;
+    quint64 m_profileGeneration = 0;
 
     KTextEditor::Document *m_scriptDoc = nullptr;
     KTextEditor::View *m_scriptView = nullptr;
@@ -0,0 +1,212 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "extractorindex.h"
+
+#include <KItinerary/ExtractorRepository>
+#include <KItinerary/ScriptExtractor>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace KItinerary;
+
+// bump this when changing the on-disk format
+constexpr inline quint32 IndexFormatVersion = 1;
+constexpr inline quint32 IndexMagic = 0x4b495849; // "KIXI"
+
+static QString indexFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/extractorindex.bin");
+}
+
+static QDataStream& operator<<(QDataStream &stream, const ExtractorFilter &filter)
+{
+    return stream << filter.mimeType() << filter.fieldName() << filter.pattern() << (qint32)filter.scope();
+}
+
+static QDataStream& operator>>(QDataStream &stream, ExtractorFilter &filter)
+{
+    QString mimeType, fieldName, pattern;
+    qint32 scope = 0;
+    stream >> mimeType >> fieldName >> pattern >> scope;
+    filter.setMimeType(mimeType);
+    filter.setFieldName(fieldName);
+    filter.setPattern(pattern);
+    filter.setScope(static_cast<ExtractorFilter::Scope>(scope));
+    return stream;
+}
+
+static QDataStream& operator<<(QDataStream &stream, const ExtractorMetaData &ext)
+{
+    stream << ext.name << ext.fileName << ext.scriptFileName << ext.scriptFunction << ext.mimeType << (quint32)ext.filters.size();
+    for (const auto &filter : ext.filters) {
+        stream << filter;
+    }
+    return stream;
+}
+
+static QDataStream& operator>>(QDataStream &stream, ExtractorMetaData &ext)
+{
+    quint32 filterCount = 0;
+    stream >> ext.name >> ext.fileName >> ext.scriptFileName >> ext.scriptFunction >> ext.mimeType >> filterCount;
+    ext.filters.clear();
+    for (quint32 i = 0; i < filterCount && stream.status() == QDataStream::Ok; ++i) {
+        ExtractorFilter filter;
+        stream >> filter;
+        ext.filters.push_back(std::move(filter));
+    }
+    return stream;
+}
+
+ExtractorIndex::ExtractorIndex() = default;
+ExtractorIndex::~ExtractorIndex() = default;
+
+ExtractorIndex::Stats ExtractorIndex::check(const QStringList &additionalSearchPaths)
+{
+    if (!m_loaded) {
+        load();
+    }
+
+    Stats stats;
+    m_checkedFiles.clear();
+    const auto searchDirs = searchPaths(additionalSearchPaths);
+    for (const auto &dir : searchDirs) {
+        QDirIterator it(dir, {QStringLiteral("*.json")}, QDir::Files);
+        while (it.hasNext()) {
+            const auto fileName = it.next();
+            if (m_checkedFiles.contains(fileName)) {
+                continue;
+            }
+            const auto fi = it.fileInfo();
+            const auto lastModified = fi.lastModified().toMSecsSinceEpoch();
+            const auto size = fi.size();
+            m_checkedFiles.insert(fileName, {lastModified, size, {}});
+
+            const auto prevIt = m_files.constFind(fileName);
+            if (prevIt != m_files.constEnd() && prevIt->lastModified == lastModified && prevIt->size == size) {
+                ++stats.unchanged;
+            } else {
+                ++stats.changed;
+                stats.changedFiles.push_back(fileName);
+            }
+        }
+    }
+    for (auto it = m_files.constBegin(); it != m_files.constEnd(); ++it) {
+        if (!m_checkedFiles.contains(it.key())) {
+            ++stats.removed;
+            stats.changedFiles.push_back(it.key());
+        }
+    }
+    return stats;
+}
+
+void ExtractorIndex::update(const ExtractorRepository &repo)
+{
+    auto files = std::move(m_checkedFiles);
+    m_checkedFiles.clear();
+    for (const auto &ext : repo.extractors()) {
+        const auto script = dynamic_cast<const ScriptExtractor*>(ext.get());
+        if (!script) {
+            continue;
+        }
+        const auto it = files.find(script->fileName());
+        if (it != files.end()) {
+            it->extractors.push_back({script->name(), script->fileName(), script->scriptFileName(), script->scriptFunction(), script->mimeType(), script->filters()});
+        }
+    }
+    m_files = std::move(files);
+    store();
+}
+
+std::vector<ExtractorMetaData> ExtractorIndex::extractors() const
+{
+    std::vector<ExtractorMetaData> extractors;
+    for (const auto &file : m_files) {
+        extractors.insert(extractors.end(), file.extractors.begin(), file.extractors.end());
+    }
+    return extractors;
+}
+
+QStringList ExtractorIndex::files() const
+{
+    return m_files.keys();
+}
+
+QStringList ExtractorIndex::searchPaths(const QStringList &additionalSearchPaths)
+{
+    // same order as ExtractorRepository
+    auto searchDirs = additionalSearchPaths;
+    searchDirs += QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("kitinerary/extractors"), QStandardPaths::LocateDirectory);
+    searchDirs.push_back(QStringLiteral(":/org.kde.pim/kitinerary/extractors"));
+    return searchDirs;
+}
+
+void ExtractorIndex::load()
+{
+    m_loaded = true;
+    QFile f(indexFileName());
+    if (!f.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&f);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0, version = 0, fileCount = 0;
+    stream >> magic >> version >> fileCount;
+    if (magic != IndexMagic || version != IndexFormatVersion) {
+        return;
+    }
+
+    QHash<QString, File> files;
+    files.reserve(fileCount);
+    for (quint32 i = 0; i < fileCount && stream.status() == QDataStream::Ok; ++i) {
+        QString fileName;
+        File file;
+        quint32 extractorCount = 0;
+        stream >> fileName >> file.lastModified >> file.size >> extractorCount;
+        for (quint32 j = 0; j < extractorCount && stream.status() == QDataStream::Ok; ++j) {
+            ExtractorMetaData ext;
+            stream >> ext;
+            file.extractors.push_back(std::move(ext));
+        }
+        files.insert(fileName, std::move(file));
+    }
+
+    // a truncated or otherwise broken index is as good as none, everything will be re-parsed
+    if (stream.status() == QDataStream::Ok) {
+        m_files = std::move(files);
+    }
+}
+
+void ExtractorIndex::store() const
+{
+    const auto fileName = indexFileName();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile f(fileName);
+    if (!f.open(QFile::WriteOnly)) {
+        qWarning() << "Failed to write extractor index:" << f.errorString() << fileName;
+        return;
+    }
+
+    QDataStream stream(&f);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << IndexMagic << IndexFormatVersion << (quint32)m_files.size();
+    for (auto it = m_files.constBegin(); it != m_files.constEnd(); ++it) {
+        stream << it.key() << it->lastModified << it->size << (quint32)it->extractors.size();
+        for (const auto &ext : it->extractors) {
+            stream << ext;
+        }
+    }
+    f.commit();
+}
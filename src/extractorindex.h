@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef EXTRACTORINDEX_H
+#define EXTRACTORINDEX_H
+
+#include <KItinerary/ExtractorFilter>
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+namespace KItinerary {
+class ExtractorRepository;
+}
+
+/** Meta data of one script extractor. */
+class ExtractorMetaData
+{
+public:
+    QString name;
+    QString fileName;
+    QString scriptFileName;
+    QString scriptFunction;
+    QString mimeType;
+    std::vector<KItinerary::ExtractorFilter> filters;
+};
+
+/** Persistent index of the extractor meta data files in the extractor repository search paths.
+ *  Entries are keyed by file path, modification time and size, so checking for changes
+ *  only needs to look at file attributes, in this or in a previous session.
+ */
+class ExtractorIndex
+{
+public:
+    ExtractorIndex();
+    ~ExtractorIndex();
+
+    class Stats {
+    public:
+        int changed = 0;
+        int unchanged = 0;
+        int removed = 0;
+        /** Added, modified and removed files. */
+        QStringList changedFiles;
+        bool hasChanges() const { return changed > 0 || removed > 0; }
+    };
+
+    /** Compares the meta data files in @p additionalSearchPaths and the default search paths
+     *  of the extractor repository against the index. Nothing is parsed here, if anything changed
+     *  the repository needs to be reloaded, followed by update().
+     */
+    Stats check(const QStringList &additionalSearchPaths);
+    /** Takes over the meta data of all script extractors in @p repo for the files found by the
+     *  last check(), and persists the index. The repository has parsed all of those already, so
+     *  this doesn't need to do that again.
+     */
+    void update(const KItinerary::ExtractorRepository &repo);
+
+    /** Meta data of all indexed extractors. */
+    std::vector<ExtractorMetaData> extractors() const;
+    /** All indexed meta data files. */
+    QStringList files() const;
+
+    /** The directories ExtractorRepository searches for meta data files, in search order. */
+    static QStringList searchPaths(const QStringList &additionalSearchPaths);
+
+private:
+    class File {
+    public:
+        qint64 lastModified = 0;
+        qint64 size = -1;
+        std::vector<ExtractorMetaData> extractors;
+    };
+    void load();
+    void store() const;
+
+    QHash<QString, File> m_files;
+    QHash<QString, File> m_checkedFiles; // result of the last check(), without meta data
+    bool m_loaded = false;
+};
+
+#endif // EXTRACTORINDEX_H
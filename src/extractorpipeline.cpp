@@ -0,0 +1,305 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "extractorpipeline.h"
+#include "stageprofile.h"
+
+#include <KItinerary/AbstractExtractor>
+#include <KItinerary/CalendarHandler>
+#include <KItinerary/ExtractorDocumentNode>
+#include <KItinerary/ExtractorDocumentProcessor>
+#include <KItinerary/ExtractorPostprocessor>
+#include <KItinerary/ExtractorRepository>
+#include <KItinerary/ExtractorResult>
+#include <KItinerary/ExtractorValidator>
+#include <KItinerary/JsonLdDocument>
+#include <KItinerary/MergeUtil>
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <KMime/Message>
+
+#include <QFile>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+using namespace KItinerary;
+
+static QVector<QVector<QVariant>> batchReservations(const QVector<QVariant> &reservations)
+{
+    QVector<QVector<QVariant>> batches;
+    QVector<QVariant> batch;
+
+    for (const auto &res : reservations) {
+        if (batch.isEmpty()) {
+            batch.push_back(res);
+            continue;
+        }
+
+        if (MergeUtil::isSameIncidence(res, batch.at(0))) {
+            batch.push_back(res);
+            continue;
+        }
+
+        batches.push_back(batch);
+        batch.clear();
+        batch.push_back(res);
+    }
+
+    if (!batch.isEmpty()) {
+        batches.push_back(batch);
+    }
+    return batches;
+}
+
+static void clearResults(ExtractorDocumentNode &node)
+{
+    if (node.isNull()) {
+        return;
+    }
+    node.setResult({});
+    for (auto child : node.childNodes()) {
+        clearResults(child);
+    }
+}
+
+// same as ExtractorEngine::extract() does it, minus the expansion of the node tree
+static void reextractNode(ExtractorDocumentNode &node, const ExtractorEngine *engine, const ExtractorRepository &repo, QString &usedExtractor)
+{
+    if (node.isNull()) {
+        return;
+    }
+
+    node.processor()->preExtract(node, engine);
+
+    std::vector<const AbstractExtractor*> extractors;
+    repo.extractorsForNode(node, extractors);
+    ExtractorResult nodeResult;
+    for (const auto extractor : extractors) {
+        auto res = extractor->extract(node, engine);
+        if (!res.isEmpty()) {
+            usedExtractor = extractor->name();
+            nodeResult.append(std::move(res));
+        }
+    }
+    if (!nodeResult.isEmpty()) {
+        node.setResult(std::move(nodeResult));
+    }
+
+    for (auto child : node.childNodes()) {
+        reextractNode(child, engine, repo, usedExtractor);
+    }
+
+    node.processor()->postExtract(node, engine);
+}
+
+static void analyzeNode(const ExtractorDocumentNode &node, const ExtractorRepository &repo, QStringList &extractorNames, QStringList &mimeTypes)
+{
+    if (node.isNull()) {
+        return;
+    }
+    if (!mimeTypes.contains(node.mimeType())) {
+        mimeTypes.push_back(node.mimeType());
+    }
+    std::vector<const AbstractExtractor*> extractors;
+    repo.extractorsForNode(node, extractors);
+    for (const auto extractor : extractors) {
+        extractorNames.push_back(extractor->name());
+    }
+    for (const auto &child : node.childNodes()) {
+        analyzeNode(child, repo, extractorNames, mimeTypes);
+    }
+}
+
+OutputStageResults& OutputStageResults::operator=(const OutputStageResults &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    std::scoped_lock lock(m_mutex, other.m_mutex);
+    m_postprocessed = other.m_postprocessed;
+    std::copy(std::begin(other.m_validated), std::end(other.m_validated), std::begin(m_validated));
+    std::copy(std::begin(other.m_iCal), std::end(other.m_iCal), std::begin(m_iCal));
+    ++m_revision;
+    return *this;
+}
+
+std::optional<QVector<QVariant>> OutputStageResults::postprocessed() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_postprocessed;
+}
+
+void OutputStageResults::setPostprocessed(const QVector<QVariant> &result)
+{
+    std::lock_guard lock(m_mutex);
+    m_postprocessed = result;
+    ++m_revision;
+}
+
+std::optional<QVector<QVariant>> OutputStageResults::validated(bool acceptCompleteOnly) const
+{
+    std::lock_guard lock(m_mutex);
+    return m_validated[acceptCompleteOnly];
+}
+
+void OutputStageResults::setValidated(bool acceptCompleteOnly, const QVector<QVariant> &result)
+{
+    std::lock_guard lock(m_mutex);
+    m_validated[acceptCompleteOnly] = result;
+    ++m_revision;
+}
+
+std::optional<QString> OutputStageResults::iCal(bool acceptCompleteOnly) const
+{
+    std::lock_guard lock(m_mutex);
+    return m_iCal[acceptCompleteOnly];
+}
+
+void OutputStageResults::setICal(bool acceptCompleteOnly, const QString &result)
+{
+    std::lock_guard lock(m_mutex);
+    m_iCal[acceptCompleteOnly] = result;
+    ++m_revision;
+}
+
+int OutputStageResults::revision() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_revision;
+}
+
+bool ExtractorPipeline::loadFile(ExtractorInput &input, const QString &fileName, QString *errorString)
+{
+    auto file = std::make_shared<QFile>(fileName);
+    if (!file->open(QFile::ReadOnly)) {
+        if (errorString) {
+            *errorString = file->errorString();
+        }
+        return false;
+    }
+
+    input.mappedFile.reset();
+    const auto size = file->size();
+    // a mapping follows changes to the file by other programs, and faults if the file gets truncated,
+    // so only take that risk where copying would actually hurt
+    constexpr qint64 MapThreshold = 16 * 1024 * 1024;
+    if (size == 0) {
+        input.data.clear();
+    } else if (size < MapThreshold) {
+        input.data = file->readAll();
+    } else if (const auto mem = file->map(0, size)) {
+        input.data = QByteArray::fromRawData(reinterpret_cast<const char*>(mem), size);
+        input.mappedFile = std::move(file);
+    } else {
+        // not mappable, e.g. a pipe or a special file system
+        input.data = file->readAll();
+    }
+    return true;
+}
+
+bool ExtractorPipeline::isText(const QByteArray &data)
+{
+    // anything binary shows that in its first few kB already, no need to look at all of a big archive
+    constexpr qsizetype SniffSize = 4096;
+    const auto end = data.begin() + std::min(data.size(), SniffSize);
+    return std::none_of(data.begin(), end, [](unsigned char c) { return std::iscntrl(c) && !std::isspace(c); });
+}
+
+std::unique_ptr<KMime::Message> ExtractorPipeline::createContextMessage(const ExtractorInput &input)
+{
+    auto msg = std::make_unique<KMime::Message>();
+    msg->from()->fromUnicodeString(input.sender);
+    msg->date()->setDateTime(input.contextDate);
+    return msg;
+}
+
+void ExtractorPipeline::setupEngine(ExtractorEngine &engine, const ExtractorInput &input)
+{
+    engine.setHints(input.hints);
+    engine.setUseSeparateProcess(input.separateProcess);
+}
+
+QJsonArray ExtractorPipeline::extract(ExtractorEngine &engine, const ExtractorInput &input, KMime::Message *context, StageProfile *profile)
+{
+    {
+        StageProfile::Measurement m(profile, QStringLiteral("setData"));
+        engine.clear();
+        engine.setContext(QVariant::fromValue<KMime::Content*>(context), u"message/rfc822");
+        engine.setData(input.data, input.fileName);
+    }
+    StageProfile::Measurement m(profile, QStringLiteral("extract"));
+    return engine.extract();
+}
+
+QJsonArray ExtractorPipeline::reextract(const ExtractorEngine &engine, const ExtractorInput &input, KMime::Message *context, QString &usedExtractor, StageProfile *profile)
+{
+    StageProfile::Measurement m(profile, QStringLiteral("script extraction"));
+    // the script engine of @p engine would keep serving already loaded scripts, so run the extractors
+    // through a fresh engine with the same settings, the document tree does not depend on which engine is used for that
+    ExtractorEngine scriptEngine;
+    setupEngine(scriptEngine, input);
+    scriptEngine.setContext(QVariant::fromValue<KMime::Content*>(context), u"message/rfc822");
+
+    ExtractorRepository repo;
+    auto root = engine.rootDocumentNode();
+    usedExtractor.clear();
+    // results of processors are recomputed in preExtract(), so nothing from the previous run is left over
+    clearResults(root);
+    reextractNode(root, &scriptEngine, repo, usedExtractor);
+    return root.result().jsonLdResult();
+}
+
+DocumentTreeAnalysis ExtractorPipeline::analyzeDocumentTree(const ExtractorEngine &engine)
+{
+    DocumentTreeAnalysis analysis;
+    ExtractorRepository repo;
+    analyzeNode(engine.rootDocumentNode(), repo, analysis.applicableExtractors, analysis.documentMimeTypes);
+    analysis.applicableExtractors.removeDuplicates();
+    return analysis;
+}
+
+QVector<QVariant> ExtractorPipeline::postprocess(const QJsonArray &data, const QDateTime &contextDate, StageProfile *profile)
+{
+    StageProfile::Measurement m(profile, QStringLiteral("ExtractorPostprocessor::process"));
+    ExtractorPostprocessor postproc;
+    postproc.setContextDate(contextDate);
+    postproc.process(JsonLdDocument::fromJson(data));
+    return postproc.result();
+}
+
+QVector<QVariant> ExtractorPipeline::validate(QVector<QVariant> result, bool acceptCompleteOnly, StageProfile *profile)
+{
+    StageProfile::Measurement m(profile, QStringLiteral("ExtractorValidator"));
+    ExtractorValidator validator;
+    validator.setAcceptOnlyCompleteElements(acceptCompleteOnly);
+    result.erase(std::remove_if(result.begin(), result.end(), [&validator](const auto &elem) {
+        return !validator.isValidElement(elem);
+    }), result.end());
+    return result;
+}
+
+QString ExtractorPipeline::toICal(const QVector<QVariant> &result, StageProfile *profile)
+{
+    KCalendarCore::Calendar::Ptr cal(new KCalendarCore::MemoryCalendar(QTimeZone::systemTimeZone()));
+    {
+        StageProfile::Measurement m(profile, QStringLiteral("CalendarHandler::fillEvent"));
+        const auto batches = batchReservations(result);
+        for (const auto &batch : batches) {
+            KCalendarCore::Event::Ptr event(new KCalendarCore::Event);
+            CalendarHandler::fillEvent(batch, event);
+            cal->addEvent(event);
+        }
+    }
+    StageProfile::Measurement m(profile, QStringLiteral("ICalFormat::toString"));
+    KCalendarCore::ICalFormat format;
+    return format.toString(cal);
+}
@@ -0,0 +1,154 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef EXTRACTORPIPELINE_H
+#define EXTRACTORPIPELINE_H
+
+#include <KItinerary/ExtractorEngine>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+
+class QFile;
+class StageProfile;
+
+namespace KMime {
+class Message;
+}
+
+/** Input data and extraction settings for one run of the extraction pipeline. */
+class ExtractorInput
+{
+public:
+    QByteArray data;
+    QString fileName;
+    QString sender;
+    QDateTime contextDate;
+    KItinerary::ExtractorEngine::Hints hints = KItinerary::ExtractorEngine::ExtractGenericIcalEvents | KItinerary::ExtractorEngine::ExtractFullPageRasterImages;
+    bool separateProcess = false;
+    /** Keeps @c data alive when that references a memory-mapped file. */
+    std::shared_ptr<const QFile> mappedFile;
+};
+
+/** Results of the pipeline stages downstream of the extractor for one ExtractorRun.
+ *  Kept along with the run, so runs taken from the result cache don't need those to be computed again.
+ *  Validation and everything after it depends on the validation mode, so those are keyed by that.
+ *  Thread-safe, as cached runs are shared between batch workers.
+ */
+class OutputStageResults
+{
+public:
+    OutputStageResults() = default;
+    OutputStageResults& operator=(const OutputStageResults &other);
+
+    std::optional<QVector<QVariant>> postprocessed() const;
+    void setPostprocessed(const QVector<QVariant> &result);
+    std::optional<QVector<QVariant>> validated(bool acceptCompleteOnly) const;
+    void setValidated(bool acceptCompleteOnly, const QVector<QVariant> &result);
+    std::optional<QString> iCal(bool acceptCompleteOnly) const;
+    void setICal(bool acceptCompleteOnly, const QString &result);
+    /** Changes whenever any stage result is set. */
+    int revision() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::optional<QVector<QVariant>> m_postprocessed;
+    std::optional<QVector<QVariant>> m_validated[2];
+    std::optional<QString> m_iCal[2];
+    int m_revision = 0;
+};
+
+/** Result of the extractor stage of the pipeline for one input.
+ *  Downstream stages are computed on demand, and kept in outputStages once computed.
+ *  For runs done in the UI this also owns the engine that produced it, as that holds
+ *  the document node tree shown in the input panel. Runs re-using the document tree of
+ *  another run share ownership of that.
+ */
+class ExtractorRun
+{
+public:
+    ExtractorInput input;
+    std::shared_ptr<KMime::Message> contextMessage;
+    std::shared_ptr<KItinerary::ExtractorEngine> engine;
+
+    QJsonArray extractorOutput;
+    QString usedExtractor;
+    /** Identifies the script output of this run, see LogScope. */
+    quint64 id = 0;
+    /** Script output of this run in batch mode, so that is available for cached runs as well.
+     *  In the UI the console keeps that instead, see ConsoleOutputModel.
+     */
+    QJsonArray consoleOutput;
+    /** Downstream stages computed so far, see OutputStages. */
+    mutable OutputStageResults outputStages;
+};
+
+/** Extractors whose filters match any node of a document tree, and the MIME types of all nodes.
+ *  For deciding whether a change to an extractor affects a run.
+ */
+class DocumentTreeAnalysis
+{
+public:
+    QStringList applicableExtractors;
+    QStringList documentMimeTypes;
+};
+
+/** The individual stages of the extraction pipeline, as shown in the output panel.
+ *  These are free of any UI dependencies and can be run on any thread.
+ */
+namespace ExtractorPipeline
+{
+
+/** Sets the data of @p input to the content of the local file @p fileName.
+ *  Large files are memory-mapped where possible, avoiding to copy them into memory.
+ *  Changes to those by other programs are visible in the data then.
+ */
+bool loadFile(ExtractorInput &input, const QString &fileName, QString *errorString = nullptr);
+
+/** Guesses whether @p data is text, based on a bounded prefix of it. */
+bool isText(const QByteArray &data);
+
+/** Creates the context message used for sender/date based extractor selection. */
+std::unique_ptr<KMime::Message> createContextMessage(const ExtractorInput &input);
+
+/** Applies the engine related settings of @p input to @p engine. */
+void setupEngine(KItinerary::ExtractorEngine &engine, const ExtractorInput &input);
+
+/** Runs the extractor engine on @p input.
+ *  @p context has to stay alive as long as the engine holds a document tree.
+ */
+QJsonArray extract(KItinerary::ExtractorEngine &engine, const ExtractorInput &input, KMime::Message *context, StageProfile *profile = nullptr);
+
+/** Re-runs the extractors on the document tree already held by @p engine, skipping document parsing.
+ *  Extractors are taken from the repository as it is now and scripts are loaded anew, so this picks up
+ *  changes to extractor scripts and their metadata. This replaces the results on the nodes of the document tree.
+ *  Unlike ExtractorEngine::extract() this doesn't consider additional extractors set on @p engine, and doesn't
+ *  update ExtractorEngine::usedCustomExtractor(), @p usedExtractor is set to the name of the extractor that
+ *  produced a result instead.
+ */
+QJsonArray reextract(const KItinerary::ExtractorEngine &engine, const ExtractorInput &input, KMime::Message *context, QString &usedExtractor, StageProfile *profile = nullptr);
+
+/** Matches the extractors currently in the repository against the entire document tree held by @p engine.
+ *  This evaluates all extractor filters on every node, so it's only worth doing on demand.
+ */
+DocumentTreeAnalysis analyzeDocumentTree(const KItinerary::ExtractorEngine &engine);
+
+QVector<QVariant> postprocess(const QJsonArray &data, const QDateTime &contextDate, StageProfile *profile = nullptr);
+QVector<QVariant> validate(QVector<QVariant> result, bool acceptCompleteOnly, StageProfile *profile = nullptr);
+QString toICal(const QVector<QVariant> &result, StageProfile *profile = nullptr);
+
+}
+
+#endif // EXTRACTORPIPELINE_H
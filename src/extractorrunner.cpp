@@ -0,0 +1,212 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "extractorrunner.h"
+#include "logcapture.h"
+
+#include <KMime/Message>
+
+#include <QCoreApplication>
+
+using namespace KItinerary;
+
+static void extractRun(ExtractorRun &run, StageProfile *profile)
+{
+    LogScope logScope(run.id);
+    run.contextMessage = ExtractorPipeline::createContextMessage(run.input);
+    run.engine = std::make_shared<ExtractorEngine>();
+    ExtractorPipeline::setupEngine(*run.engine, run.input);
+    run.extractorOutput = ExtractorPipeline::extract(*run.engine, run.input, run.contextMessage.get(), profile);
+    run.usedExtractor = run.engine->usedCustomExtractor();
+}
+
+ExtractorRunner::ExtractorRunner(QObject *parent)
+    : QObject(parent)
+{
+    // everything engine related happens on one thread, the script engine in there is
+    // bound to the thread it has been created on
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+}
+
+ExtractorRunner::~ExtractorRunner()
+{
+    cancel();
+    m_pool.waitForDone();
+    // results still queued for delivery would otherwise release their engine after m_pool is gone
+    QCoreApplication::removePostedEvents(this);
+    m_pool.waitForDone();
+}
+
+std::shared_ptr<ExtractorRun> ExtractorRunner::createRun(const ExtractorInput &input)
+{
+    // runs are destroyed on the worker thread as well, the engine in there has thread affinity
+    auto pool = &m_pool;
+    std::shared_ptr<ExtractorRun> run(new ExtractorRun, [pool](ExtractorRun *run) {
+        pool->start([run]() { delete run; });
+    });
+    run->input = input;
+    run->id = LogScope::createRunId();
+    return run;
+}
+
+void ExtractorRunner::run(const ExtractorInput &input, CachePolicy cachePolicy)
+{
+    auto run = createRun(input);
+    const auto generation = ++m_generation;
+
+    Q_EMIT started();
+    m_pool.start([this, run, generation, cachePolicy]() { execute(run, generation, cachePolicy); });
+}
+
+void ExtractorRunner::rerunScripts(const std::shared_ptr<ExtractorRun> &previous)
+{
+    auto run = createRun(previous->input);
+    const auto generation = ++m_generation;
+
+    Q_EMIT started();
+    m_pool.start([this, run, previous, generation]() { executeScripts(run, previous, generation); });
+}
+
+void ExtractorRunner::prefetch(const std::vector<ExtractorInput> &inputs)
+{
+    const auto generation = ++m_prefetchGeneration;
+    for (const auto &input : inputs) {
+        auto run = createRun(input);
+        // lower priority, so explicitly requested runs overtake this
+        m_pool.start([this, run, generation]() { executePrefetch(run, generation); }, -1);
+    }
+}
+
+void ExtractorRunner::cancel()
+{
+    ++m_generation;
+    ++m_prefetchGeneration;
+}
+
+void ExtractorRunner::post(std::function<void()> &&job)
+{
+    m_pool.start(std::move(job));
+}
+
+void ExtractorRunner::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+ResultCache* ExtractorRunner::cache()
+{
+    return &m_cache;
+}
+
+bool ExtractorRunner::isStale(quint64 generation) const
+{
+    return generation != m_generation;
+}
+
+void ExtractorRunner::execute(const std::shared_ptr<ExtractorRun> &run, quint64 generation, CachePolicy cachePolicy)
+{
+    if (isStale(generation)) {
+        return;
+    }
+
+    StageProfile profile;
+    QByteArray cacheKey;
+    std::shared_ptr<ExtractorRun> cachedRun;
+    {
+        StageProfile::Measurement m(&profile, QStringLiteral("cache lookup"));
+        cacheKey = m_cache.key(run->input);
+        if (cachePolicy == UseCache) {
+            cachedRun = m_cache.lookup(cacheKey);
+        }
+    }
+    if (cachedRun) {
+        deliverCached(cachedRun, run, cacheKey, std::move(profile), generation);
+        return;
+    }
+
+    extractRun(*run, &profile);
+    m_cache.insert(cacheKey, run);
+    deliver(run, std::move(profile), generation);
+}
+
+void ExtractorRunner::executePrefetch(const std::shared_ptr<ExtractorRun> &run, quint64 generation)
+{
+    if (generation != m_prefetchGeneration) {
+        return;
+    }
+
+    // don't displace the memorized hash of the current input, that is looked up far more often
+    const auto cacheKey = m_cache.key(run->input, false);
+    if (m_cache.lookup(cacheKey)) {
+        return;
+    }
+    extractRun(*run, nullptr);
+    // most prefetched results are never opened, so don't keep their entire document tree around for that
+    run->engine.reset();
+    run->contextMessage.reset();
+    m_cache.insert(cacheKey, run);
+}
+
+void ExtractorRunner::executeScripts(const std::shared_ptr<ExtractorRun> &run, const std::shared_ptr<ExtractorRun> &previous, quint64 generation)
+{
+    if (isStale(generation)) {
+        return;
+    }
+    if (!previous->engine || previous->engine->rootDocumentNode().isNull()) {
+        execute(run, generation, UseCache);
+        return;
+    }
+
+    StageProfile profile;
+    QByteArray cacheKey;
+    std::shared_ptr<ExtractorRun> cachedRun;
+    {
+        StageProfile::Measurement m(&profile, QStringLiteral("cache lookup"));
+        cacheKey = m_cache.key(run->input);
+        cachedRun = m_cache.lookup(cacheKey);
+    }
+    if (cachedRun) {
+        deliverCached(cachedRun, run, cacheKey, std::move(profile), generation);
+        return;
+    }
+
+    // the document tree references the context message, so both are shared together
+    run->contextMessage = previous->contextMessage;
+    run->engine = previous->engine;
+    // node results of the shared tree will not match what is cached for previous anymore
+    m_cache.remove(previous);
+    LogScope logScope(run->id);
+    run->extractorOutput = ExtractorPipeline::reextract(*run->engine, run->input, run->contextMessage.get(), run->usedExtractor, &profile);
+
+    m_cache.insert(cacheKey, run);
+    deliver(run, std::move(profile), generation);
+}
+
+void ExtractorRunner::deliverCached(const std::shared_ptr<ExtractorRun> &cachedRun, const std::shared_ptr<ExtractorRun> &run, const QByteArray &cacheKey, StageProfile &&profile, quint64 generation)
+{
+    deliver(cachedRun, std::move(profile), generation);
+    if (cachedRun->engine || isStale(generation)) {
+        return;
+    }
+
+    // prefetched and on-disk results have no document tree, so build that for the input panel
+    // the results are shown already meanwhile, and don't change by this
+    StageProfile rebuildProfile;
+    extractRun(*run, &rebuildProfile);
+    run->outputStages = cachedRun->outputStages;
+    m_cache.insert(cacheKey, run);
+    deliver(run, std::move(rebuildProfile), generation);
+}
+
+void ExtractorRunner::deliver(const std::shared_ptr<ExtractorRun> &run, StageProfile &&profile, quint64 generation)
+{
+    QMetaObject::invokeMethod(this, [this, run, profile = std::move(profile), generation]() {
+        if (!isStale(generation)) {
+            Q_EMIT finished(run, profile);
+        }
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,85 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef EXTRACTORRUNNER_H
+#define EXTRACTORRUNNER_H
+
+#include "extractorpipeline.h"
+#include "resultcache.h"
+#include "stageprofile.h"
+
+#include <QObject>
+#include <QThreadPool>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/** Runs the extraction pipeline on a background thread.
+ *  Only the most recently requested run is ever reported back, results of
+ *  superseded runs are dropped as early as possible.
+ */
+class ExtractorRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ExtractorRunner(QObject *parent = nullptr);
+    ~ExtractorRunner();
+
+    enum CachePolicy {
+        UseCache,
+        BypassCache,
+    };
+
+    /** Starts a new run, superseding any run still in progress. */
+    void run(const ExtractorInput &input, CachePolicy cachePolicy = UseCache);
+    /** Re-runs only the extractors on the document tree of @p previous, superseding any run still in progress.
+     *  The new run shares the engine and document tree of @p previous. That replaces the node results
+     *  of @p previous, which is therefore dropped from the cache.
+     *  Falls back to a full run if @p previous has no document tree.
+     */
+    void rerunScripts(const std::shared_ptr<ExtractorRun> &previous);
+    /** Extracts @p inputs in the background after the current run, only to populate the cache.
+     *  Those results don't keep their document tree, that is rebuilt once one of them is actually run.
+     *  Supersedes any prefetching requested earlier.
+     */
+    void prefetch(const std::vector<ExtractorInput> &inputs);
+    /** Drops the result of any run still in progress, and any pending prefetching. */
+    void cancel();
+    /** Runs @p job on the background thread, after everything already queued there.
+     *  For anything touching documents of an engine, as that is not safe concurrently with extraction.
+     */
+    void post(std::function<void()> &&job);
+    /** Blocks until the background thread is idle.
+     *  Needed before touching global state the engine uses, such as the extractor repository.
+     */
+    void waitForDone();
+
+    ResultCache* cache();
+
+Q_SIGNALS:
+    void started();
+    /** @p profile covers the background stages of this very run, ie. only the cache lookup for cached results. */
+    void finished(const std::shared_ptr<ExtractorRun> &run, const StageProfile &profile);
+
+private:
+    std::shared_ptr<ExtractorRun> createRun(const ExtractorInput &input);
+    bool isStale(quint64 generation) const;
+    void executeScripts(const std::shared_ptr<ExtractorRun> &run, const std::shared_ptr<ExtractorRun> &previous, quint64 generation);
+    void execute(const std::shared_ptr<ExtractorRun> &run, quint64 generation, CachePolicy cachePolicy);
+    void executePrefetch(const std::shared_ptr<ExtractorRun> &run, quint64 generation);
+    /** Delivers @p cachedRun, followed by @p run with the document tree rebuilt if @p cachedRun has none. */
+    void deliverCached(const std::shared_ptr<ExtractorRun> &cachedRun, const std::shared_ptr<ExtractorRun> &run, const QByteArray &cacheKey, StageProfile &&profile, quint64 generation);
+    void deliver(const std::shared_ptr<ExtractorRun> &run, StageProfile &&profile, quint64 generation);
+
+    QThreadPool m_pool;
+    ResultCache m_cache;
+    std::atomic<quint64> m_generation = 0;
+    std::atomic<quint64> m_prefetchGeneration = 0;
+};
+
+#endif // EXTRACTORRUNNER_H
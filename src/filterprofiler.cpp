@@ -0,0 +1,118 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "filterprofiler.h"
+
+#include <KItinerary/ExtractorDocumentNode>
+#include <KItinerary/ExtractorFilter>
+
+#include <QElapsedTimer>
+
+using namespace KItinerary;
+
+namespace {
+/** A node together with its position in the tree, as child indexes separated by slashes. */
+struct PathNode {
+    ExtractorDocumentNode node;
+    QString path;
+};
+}
+
+static void collectNodes(const ExtractorDocumentNode &node, const QString &path, std::vector<PathNode> &nodes)
+{
+    if (node.isNull()) {
+        return;
+    }
+    nodes.push_back({node, path});
+    const auto &children = node.childNodes();
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        collectNodes(children[i], path + QLatin1Char('/') + QString::number(i), nodes);
+    }
+}
+
+static QString parentPath(const QString &path)
+{
+    const auto idx = path.lastIndexOf(QLatin1Char('/'));
+    return idx > 0 ? path.left(idx) : QString();
+}
+
+/** Nodes @p filter looks at when evaluated on @p n, as given by its scope. */
+static std::vector<PathNode> scopeNodes(const ExtractorFilter &filter, const PathNode &n)
+{
+    std::vector<PathNode> nodes;
+    switch (filter.scope()) {
+        case ExtractorFilter::Current:
+            nodes.push_back(n);
+            break;
+        case ExtractorFilter::Parent:
+            if (!n.node.parent().isNull()) {
+                nodes.push_back({n.node.parent(), parentPath(n.path)});
+            }
+            break;
+        case ExtractorFilter::Ancestors:
+            for (auto p = PathNode{n.node.parent(), parentPath(n.path)}; !p.node.isNull(); p = PathNode{p.node.parent(), parentPath(p.path)}) {
+                nodes.push_back(p);
+            }
+            break;
+        case ExtractorFilter::Children:
+        {
+            const auto &children = n.node.childNodes();
+            for (std::size_t i = 0; i < children.size(); ++i) {
+                nodes.push_back({children[i], n.path + QLatin1Char('/') + QString::number(i)});
+            }
+            break;
+        }
+        case ExtractorFilter::Descendants:
+        {
+            const auto &children = n.node.childNodes();
+            for (std::size_t i = 0; i < children.size(); ++i) {
+                collectNodes(children[i], n.path + QLatin1Char('/') + QString::number(i), nodes);
+            }
+            break;
+        }
+    }
+    return nodes;
+}
+
+std::vector<FilterProfile> FilterProfile::profile(const std::vector<ExtractorFilter> &filters, const ExtractorDocumentNode &root)
+{
+    std::vector<PathNode> nodes;
+    collectNodes(root, QStringLiteral("0"), nodes);
+
+    std::vector<FilterProfile> profiles;
+    profiles.reserve(filters.size());
+    for (const auto &filter : filters) {
+        FilterProfile profile;
+        // the same filter restricted to a single node, to find out what exactly matched
+        auto currentFilter = filter;
+        currentFilter.setScope(ExtractorFilter::Current);
+
+        for (const auto &n : nodes) {
+            QElapsedTimer timer;
+            timer.start();
+            const auto matched = filter.matches(n.node);
+            const auto elapsed = timer.nsecsElapsed();
+
+            ++profile.evaluatedNodes;
+            profile.totalTime += elapsed;
+            if (elapsed > profile.maxTime) {
+                profile.maxTime = elapsed;
+                profile.slowestNodePath = n.path;
+            }
+
+            if (!matched) {
+                continue;
+            }
+            for (const auto &candidate : scopeNodes(filter, n)) {
+                if (currentFilter.matches(candidate.node)) {
+                    profile.matches.push_back({candidate.path, candidate.node.mimeType(), n.path});
+                }
+            }
+        }
+        profiles.push_back(std::move(profile));
+    }
+    return profiles;
+}
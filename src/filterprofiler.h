@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef FILTERPROFILER_H
+#define FILTERPROFILER_H
+
+#include <QString>
+
+#include <vector>
+
+namespace KItinerary {
+class ExtractorDocumentNode;
+class ExtractorFilter;
+}
+
+/** Cost and matches of one extractor filter on an entire document tree. */
+class FilterProfile
+{
+public:
+    /** A node the filter matched on, and the node it was evaluated for.
+     *  Those differ for filters not applying to the current node only, see ExtractorFilter::Scope.
+     */
+    class Match
+    {
+    public:
+        QString nodePath;
+        QString mimeType;
+        QString triggerPath;
+    };
+
+    int evaluatedNodes = 0;
+    qint64 totalTime = 0; // nsecs
+    qint64 maxTime = 0; // nsecs
+    QString slowestNodePath;
+    std::vector<Match> matches;
+
+    /** Evaluates each of @p filters on every node of the tree below @p root.
+     *  This has to run on the thread the document tree belongs to.
+     */
+    static std::vector<FilterProfile> profile(const std::vector<KItinerary::ExtractorFilter> &filters, const KItinerary::ExtractorDocumentNode &root);
+};
+
+#endif // FILTERPROFILER_H
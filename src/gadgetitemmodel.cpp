@@ -0,0 +1,37 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "gadgetitemmodel.h"
+#include "standarditemmodelhelper.h"
+
+GadgetItemModel::GadgetItemModel(QObject *parent)
+    : QStandardItemModel(parent)
+{
+}
+
+GadgetItemModel::~GadgetItemModel() = default;
+
+bool GadgetItemModel::hasChildren(const QModelIndex &parent) const
+{
+    return canFetchMore(parent) || QStandardItemModel::hasChildren(parent);
+}
+
+bool GadgetItemModel::canFetchMore(const QModelIndex &parent) const
+{
+    const auto item = itemFromIndex(parent);
+    return item && item->data(PendingValueRole).isValid();
+}
+
+void GadgetItemModel::fetchMore(const QModelIndex &parent)
+{
+    auto item = itemFromIndex(parent);
+    if (!item) {
+        return;
+    }
+    const auto value = item->data(PendingValueRole);
+    item->setData(QVariant(), PendingValueRole);
+    StandardItemModelHelper::fillFromValue(value, item);
+}
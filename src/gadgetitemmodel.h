@@ -0,0 +1,33 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef GADGETITEMMODEL_H
+#define GADGETITEMMODEL_H
+
+#include <QStandardItemModel>
+
+/** Item model for showing the content of gadgets, filled by StandardItemModelHelper::fillFromGadget().
+ *  Child gadgets and lists are only read once their parent row is expanded, which matters for
+ *  deeply nested content such as UIC DOSIPAS ASN.1 trees.
+ */
+class GadgetItemModel : public QStandardItemModel
+{
+    Q_OBJECT
+public:
+    explicit GadgetItemModel(QObject *parent = nullptr);
+    ~GadgetItemModel();
+
+    enum {
+        /** Child gadget or list value of an item that has not been expanded yet. */
+        PendingValueRole = Qt::UserRole + 1
+    };
+
+    bool hasChildren(const QModelIndex &parent = {}) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+};
+
+#endif // GADGETITEMMODEL_H
@@ -0,0 +1,162 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "hexview.h"
+
+#include <KColorScheme>
+
+#include <QEvent>
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+
+#include <algorithm>
+
+constexpr inline int BytesPerRow = 16;
+// offset, separator, hex bytes with an extra gap in the middle, separator, ASCII
+constexpr inline int OffsetChars = 8;
+constexpr inline int HexColumn = OffsetChars + 2;
+constexpr inline int AsciiColumn = HexColumn + BytesPerRow * 3 + 2;
+constexpr inline int LineChars = AsciiColumn + BytesPerRow;
+
+static int hexColumn(int byte)
+{
+    return HexColumn + byte * 3 + (byte >= BytesPerRow / 2 ? 1 : 0);
+}
+
+HexView::HexView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    verticalScrollBar()->setSingleStep(1);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, viewport(), qOverload<>(&QWidget::update));
+    connect(horizontalScrollBar(), &QScrollBar::valueChanged, viewport(), qOverload<>(&QWidget::update));
+    updateScrollBars();
+}
+
+HexView::~HexView() = default;
+
+void HexView::setData(const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile)
+{
+    m_data = data;
+    m_mappedFile = mappedFile;
+    m_highlightBegin = m_highlightEnd = 0;
+    verticalScrollBar()->setValue(0);
+    updateScrollBars();
+    viewport()->update();
+}
+
+void HexView::clear()
+{
+    setData({}, {});
+}
+
+void HexView::setHighlight(qsizetype offset, qsizetype size)
+{
+    m_highlightBegin = std::clamp<qsizetype>(offset, 0, m_data.size());
+    m_highlightEnd = std::clamp<qsizetype>(offset + size, m_highlightBegin, m_data.size());
+
+    const auto firstRow = (int)(m_highlightBegin / BytesPerRow);
+    const auto lastRow = (int)((std::max(m_highlightEnd, m_highlightBegin + 1) - 1) / BytesPerRow);
+    const auto top = verticalScrollBar()->value();
+    if (firstRow < top || lastRow >= top + visibleRowCount()) {
+        verticalScrollBar()->setValue(firstRow);
+    }
+    viewport()->update();
+}
+
+void HexView::clearHighlight()
+{
+    setHighlight(0, 0);
+}
+
+void HexView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter p(viewport());
+    p.translate(-horizontalScrollBar()->value(), 0);
+
+    const KColorScheme colors(QPalette::Normal);
+    const auto highlightBrush = colors.background(KColorScheme::NeutralBackground);
+    const auto offsetColor = colors.foreground(KColorScheme::InactiveText).color();
+    const auto textColor = palette().color(QPalette::Text);
+
+    static constexpr const char hexDigits[] = "0123456789abcdef";
+    QString line(LineChars, QLatin1Char(' '));
+    const auto firstRow = verticalScrollBar()->value();
+    const auto lastRow = std::min(rowCount(), firstRow + visibleRowCount());
+    for (auto row = firstRow; row < lastRow; ++row) {
+        const auto y = (row - firstRow) * m_rowHeight;
+        const auto rowBegin = (qsizetype)row * BytesPerRow;
+        const auto rowEnd = std::min(rowBegin + BytesPerRow, m_data.size());
+
+        line.fill(QLatin1Char(' '));
+        auto offset = rowBegin;
+        for (auto i = OffsetChars - 1; i >= 0; --i, offset >>= 4) {
+            line[i] = QLatin1Char(hexDigits[offset & 0xf]);
+        }
+        for (auto pos = rowBegin; pos < rowEnd; ++pos) {
+            const auto byte = (int)pos - (int)rowBegin;
+            const auto c = (uint8_t)m_data.at(pos);
+            line[hexColumn(byte)] = QLatin1Char(hexDigits[c >> 4]);
+            line[hexColumn(byte) + 1] = QLatin1Char(hexDigits[c & 0xf]);
+            line[AsciiColumn + byte] = (c >= 0x20 && c < 0x7f) ? QLatin1Char((char)c) : QLatin1Char('.');
+
+            if (pos >= m_highlightBegin && pos < m_highlightEnd) {
+                p.fillRect(hexColumn(byte) * m_charWidth, y, 2 * m_charWidth, m_rowHeight, highlightBrush);
+                p.fillRect((AsciiColumn + byte) * m_charWidth, y, m_charWidth, m_rowHeight, highlightBrush);
+            }
+        }
+
+        const auto baseline = y + fontMetrics().ascent();
+        p.setPen(offsetColor);
+        p.drawText(0, baseline, line.left(OffsetChars));
+        p.setPen(textColor);
+        p.drawText(HexColumn * m_charWidth, baseline, line.mid(HexColumn));
+    }
+}
+
+void HexView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void HexView::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        updateScrollBars();
+    }
+}
+
+void HexView::updateScrollBars()
+{
+    m_rowHeight = std::max(1, fontMetrics().height());
+    m_charWidth = std::max(1, fontMetrics().horizontalAdvance(QLatin1Char('0')));
+
+    const auto visibleRows = std::max(1, viewport()->height() / m_rowHeight);
+    verticalScrollBar()->setPageStep(visibleRows);
+    verticalScrollBar()->setRange(0, std::max(0, rowCount() - visibleRows));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, std::max(0, lineWidth() - viewport()->width()));
+}
+
+int HexView::rowCount() const
+{
+    return (int)((m_data.size() + BytesPerRow - 1) / BytesPerRow);
+}
+
+int HexView::visibleRowCount() const
+{
+    // including a partially visible last row
+    return viewport()->height() / m_rowHeight + 1;
+}
+
+int HexView::lineWidth() const
+{
+    return LineChars * m_charWidth;
+}
@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef HEXVIEW_H
+#define HEXVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+
+#include <memory>
+
+class QFile;
+
+/** Hex and ASCII view of binary data.
+ *  Only the visible rows are rendered, straight from the data, so this works for
+ *  multi-megabyte inputs without creating any text representation of them.
+ */
+class HexView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit HexView(QWidget *parent = nullptr);
+    ~HexView();
+
+    /** Shows @p data, which is not copied.
+     *  @p mappedFile is kept alive as long as @p data is shown, in case that refers to a memory-mapped file.
+     */
+    void setData(const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile = {});
+    void clear();
+
+    /** Highlights @p size bytes starting at @p offset and scrolls to them. */
+    void setHighlight(qsizetype offset, qsizetype size);
+    void clearHighlight();
+
+    /** Item data roles for the byte range an item corresponds to, for use with setHighlight(). */
+    enum {
+        OffsetRole = Qt::UserRole + 10,
+        SizeRole,
+    };
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private:
+    void updateScrollBars();
+    int rowCount() const;
+    int visibleRowCount() const;
+    int lineWidth() const;
+
+    QByteArray m_data;
+    std::shared_ptr<const QFile> m_mappedFile;
+    qsizetype m_highlightBegin = 0;
+    qsizetype m_highlightEnd = 0;
+    int m_rowHeight = 0;
+    int m_charWidth = 0;
+};
+
+#endif // HEXVIEW_H
@@ -0,0 +1,433 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "imagemodel.h"
+#include "extractorrunner.h"
+
+#include <KItinerary/BarcodeDecoder>
+
+#include <KLocalizedString>
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QLocale>
+
+#include <algorithm>
+
+using namespace KItinerary;
+
+// in pixels, for the longer side
+constexpr inline int ThumbnailSize = 384;
+// in kB, a full page scan at 300dpi is about 25MB
+constexpr inline int FullImageCacheSize = 256 * 1024;
+// in entries, results are tiny
+constexpr inline int BarcodeCacheSize = 4096;
+
+static QString formatElapsed(qint64 ns)
+{
+    return QLocale().toString(ns / 1'000'000.0, 'f', 1);
+}
+
+static QByteArray barcodeCacheKey(const QImage &img)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(img.constBits()), img.sizeInBytes()));
+    return hash.result() + QByteArray::number(img.width()) + 'x' + QByteArray::number(img.height()) + ':' + QByteArray::number(int(img.format()));
+}
+
+static QSize thumbnailSize(QSize size)
+{
+    if (size.width() <= ThumbnailSize && size.height() <= ThumbnailSize) {
+        return size;
+    }
+    return size.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio);
+}
+
+ImageModel::ImageModel(QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_fullImages(FullImageCacheSize)
+    , m_barcodeCache(BarcodeCacheSize)
+{
+}
+
+ImageModel::~ImageModel() = default;
+
+void ImageModel::setRunner(ExtractorRunner *runner)
+{
+    m_runner = runner;
+}
+
+void ImageModel::setPdf(const PdfDocument *pdf, const std::shared_ptr<const void> &owner)
+{
+    beginResetModel();
+    ++m_generation;
+    m_images.clear();
+    m_pages.clear();
+    m_fullImages.clear();
+    m_owner = owner;
+
+    // this only reads the image metadata, nothing gets decoded here
+    if (pdf) {
+        m_pages.reserve(pdf->pageCount());
+        for (int i = 0; i < pdf->pageCount(); ++i) {
+            const auto page = pdf->page(i);
+            m_pages.push_back({(int)m_images.size(), page.imageCount()});
+            for (int j = 0; j < page.imageCount(); ++j) {
+                Image img;
+                img.pdfImage = page.image(j);
+                m_images.push_back(std::move(img));
+            }
+        }
+    }
+    endResetModel();
+}
+
+void ImageModel::setImage(const QImage &image)
+{
+    beginResetModel();
+    ++m_generation;
+    m_images.clear();
+    m_pages.clear();
+    m_fullImages.clear();
+    m_owner.reset();
+
+    Image img;
+    img.image = image;
+    m_images.push_back(std::move(img));
+    endResetModel();
+}
+
+void ImageModel::clear()
+{
+    beginResetModel();
+    ++m_generation;
+    m_images.clear();
+    m_pages.clear();
+    m_fullImages.clear();
+    m_owner.reset();
+    endResetModel();
+}
+
+void ImageModel::requestImage(const QModelIndex &index, std::function<void(const QImage&)> &&callback)
+{
+    const auto image = imageNumber(index);
+    if (image < 0) {
+        callback({});
+        return;
+    }
+    fullImage(image, std::move(callback));
+}
+
+void ImageModel::requestBarcode(const QModelIndex &index, std::function<void(const QVariant&)> &&callback)
+{
+    const auto image = imageNumber(index);
+    if (image < 0) {
+        callback({});
+        return;
+    }
+    scanBarcode(image, std::move(callback));
+}
+
+void ImageModel::scanBarcodes()
+{
+    for (auto i = 0; i < (int)m_images.size(); ++i) {
+        scanBarcode(i, {});
+    }
+}
+
+void ImageModel::fullImage(int image, std::function<void(const QImage&)> &&callback)
+{
+    if (!m_images[image].image.isNull()) {
+        callback(m_images[image].image);
+        return;
+    }
+    if (const auto img = m_fullImages.object(image)) {
+        callback(*img);
+        return;
+    }
+    decode(image, std::move(callback));
+}
+
+QModelIndex ImageModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return {};
+    }
+    return createIndex(row, column, parent.isValid() ? parent.row() + 1 : 0);
+}
+
+QModelIndex ImageModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || child.internalId() == 0) {
+        return {};
+    }
+    return createIndex((int)child.internalId() - 1, 0, (quintptr)0);
+}
+
+int ImageModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_pages.empty() ? (int)m_images.size() : (int)m_pages.size();
+    }
+    if (parent.column() > 0 || parent.internalId() != 0 || m_pages.empty()) {
+        return 0;
+    }
+    return m_pages[parent.row()].imageCount;
+}
+
+int ImageModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+QVariant ImageModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto image = imageNumber(index);
+    if (image < 0) {
+        if (role == Qt::DisplayRole) {
+            return i18n("Page %1", index.row() + 1);
+        }
+        return {};
+    }
+
+    const auto &img = m_images[image];
+    if (index.column() == BarcodeColumn) {
+        return barcodeData(img, role);
+    }
+
+    const auto sourceSize = img.image.isNull() ? QSize(img.pdfImage.width(), img.pdfImage.height()) : img.image.size();
+    switch (role) {
+        case Qt::DecorationRole:
+            // only visible rows ask for this
+            if (img.thumbnail.isNull()) {
+                requestThumbnail(image);
+                return {};
+            }
+            return img.thumbnail;
+        case Qt::SizeHintRole:
+            // reserve the space the thumbnail will need, avoids the layout jumping around while scrolling
+            if (img.thumbnail.isNull()) {
+                return thumbnailSize(sourceSize);
+            }
+            break;
+        case Qt::ToolTipRole:
+            if (!img.image.isNull()) {
+                return i18n("Size: %1 x %2", img.image.width(), img.image.height());
+            }
+            if (img.thumbnail.isNull()) {
+                return i18n("Size: %1 x %2\nSource: %3 x %4", img.pdfImage.width(), img.pdfImage.height(), img.pdfImage.sourceWidth(), img.pdfImage.sourceHeight());
+            }
+            return i18n("Size: %1 x %2\nSource: %3 x %4\nSkipped: %5", img.pdfImage.width(), img.pdfImage.height(), img.pdfImage.sourceWidth(), img.pdfImage.sourceHeight(), img.skippedByExtractor);
+    }
+    return {};
+}
+
+QVariant ImageModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+            case ImageColumn:
+                return i18n("Image");
+            case BarcodeColumn:
+                return i18n("Barcode");
+        }
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+int ImageModel::imageNumber(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return -1;
+    }
+    if (m_pages.empty()) {
+        return index.row();
+    }
+    if (index.internalId() == 0) {
+        return -1;
+    }
+    return m_pages[index.internalId() - 1].firstImage + index.row();
+}
+
+QModelIndex ImageModel::imageIndex(int image) const
+{
+    if (m_pages.empty()) {
+        return index(image, 0);
+    }
+    // the last page starting at or before the image, pages without images don't matter here
+    const auto it = std::prev(std::upper_bound(m_pages.begin(), m_pages.end(), image, [](int image, const Page &page) {
+        return image < page.firstImage;
+    }));
+    const auto page = (int)std::distance(m_pages.begin(), it);
+    return createIndex(image - it->firstImage, 0, page + 1);
+}
+
+void ImageModel::requestThumbnail(int image) const
+{
+    auto &img = m_images[image];
+    if (img.requested || !m_runner) {
+        return;
+    }
+    img.requested = true;
+    decode(image, {});
+}
+
+void ImageModel::decode(int image, std::function<void(const QImage&)> &&done) const
+{
+    if (!m_runner) {
+        if (done) {
+            done({});
+        }
+        return;
+    }
+
+    // PDF decoding is not safe to do concurrently with extraction, so this has to go to the extractor thread
+    auto self = const_cast<ImageModel*>(this);
+    const auto &entry = m_images[image];
+    m_runner->post([self, image, pdfImage = entry.pdfImage, img = entry.image, owner = m_owner, generation = m_generation.load(), done = std::move(done)]() mutable {
+        const auto isStale = [self, generation]() { return generation != self->m_generation.load(std::memory_order_relaxed); };
+        if (isStale()) {
+            return;
+        }
+        bool skippedByExtractor = false;
+        if (img.isNull()) {
+            img = pdfImage.image();
+            if (img.isNull() && !isStale()) {
+                skippedByExtractor = true;
+                pdfImage.setLoadingHints(PdfImage::NoHint);
+                img = pdfImage.image();
+            }
+        }
+        const auto size = thumbnailSize(img.size());
+        const auto thumbnail = size == img.size() ? img : img.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+        QMetaObject::invokeMethod(self, [self, image, img, thumbnail, skippedByExtractor, generation, done]() {
+            if (generation != self->m_generation) {
+                return;
+            }
+            self->decoded(image, img, thumbnail, skippedByExtractor);
+            if (done) {
+                done(img);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImageModel::decoded(int image, const QImage &img, const QImage &thumbnail, bool skippedByExtractor)
+{
+    auto &entry = m_images[image];
+    entry.requested = true;
+    entry.skippedByExtractor = skippedByExtractor;
+    if (entry.image.isNull() && !img.isNull()) {
+        m_fullImages.insert(image, new QImage(img), std::max<qsizetype>(1, img.sizeInBytes() / 1024));
+    }
+    if (entry.thumbnail.isNull()) {
+        entry.thumbnail = thumbnail;
+        const auto idx = imageIndex(image);
+        Q_EMIT dataChanged(idx, idx);
+    }
+}
+
+void ImageModel::scanBarcode(int image, std::function<void(const QVariant&)> &&callback)
+{
+    auto &entry = m_images[image];
+    if (entry.barcodeState == Image::BarcodeScanned) {
+        if (callback) {
+            callback(entry.barcode);
+        }
+        return;
+    }
+    if (callback) {
+        entry.barcodeCallbacks.push_back(std::move(callback));
+    }
+    if (entry.barcodeState == Image::BarcodePending) {
+        return;
+    }
+    entry.barcodeState = Image::BarcodePending;
+    const auto idx = imageIndex(image).siblingAtColumn(BarcodeColumn);
+    Q_EMIT dataChanged(idx, idx);
+
+    // images are decoded one at a time on the extractor thread, barcode decoding can run in parallel
+    fullImage(image, [this, image, generation = m_generation.load()](const QImage &img) {
+        m_barcodePool.start([this, image, img, generation]() {
+            const auto key = barcodeCacheKey(img);
+            BarcodeResult result;
+            bool cached = false;
+            {
+                std::lock_guard lock(m_barcodeCacheMutex);
+                if (const auto r = m_barcodeCache.object(key)) {
+                    result = *r;
+                    cached = true;
+                }
+            }
+            if (!cached) {
+                QElapsedTimer timer;
+                timer.start();
+                KItinerary::BarcodeDecoder decoder;
+                result.content = decoder.decode(img, BarcodeDecoder::Any | BarcodeDecoder::IgnoreAspectRatio);
+                result.elapsedNs = timer.nsecsElapsed();
+                std::lock_guard lock(m_barcodeCacheMutex);
+                m_barcodeCache.insert(key, new BarcodeResult(result));
+            }
+
+            QMetaObject::invokeMethod(this, [this, image, result, generation]() {
+                if (generation == m_generation) {
+                    barcodeScanned(image, result);
+                }
+            }, Qt::QueuedConnection);
+        });
+    });
+}
+
+void ImageModel::barcodeScanned(int image, const BarcodeResult &result)
+{
+    auto &entry = m_images[image];
+    entry.barcodeState = Image::BarcodeScanned;
+    entry.barcode = result.content;
+    entry.barcodeElapsedNs = result.elapsedNs;
+    const auto callbacks = std::move(entry.barcodeCallbacks);
+    entry.barcodeCallbacks.clear();
+
+    const auto idx = imageIndex(image).siblingAtColumn(BarcodeColumn);
+    Q_EMIT dataChanged(idx, idx);
+    for (const auto &callback : callbacks) {
+        callback(result.content);
+    }
+}
+
+QVariant ImageModel::barcodeData(const Image &img, int role) const
+{
+    if (img.barcodeState == Image::BarcodePending && role == Qt::DisplayRole) {
+        return i18n("Scanning...");
+    }
+    if (img.barcodeState != Image::BarcodeScanned) {
+        return {};
+    }
+
+    const auto elapsed = formatElapsed(img.barcodeElapsedNs);
+    switch (role) {
+        case Qt::DisplayRole:
+            if (img.barcode.isNull()) {
+                return i18n("No barcode (%1 ms)", elapsed);
+            }
+            if (img.barcode.typeId() == QMetaType::QByteArray) {
+                return i18n("Binary, %1 bytes (%2 ms)", img.barcode.toByteArray().size(), elapsed);
+            }
+            return i18n("Text, %1 characters (%2 ms)", img.barcode.toString().size(), elapsed);
+        case Qt::ToolTipRole:
+            // a preview only, the full content is available via the context menu
+            if (img.barcode.typeId() == QMetaType::QByteArray) {
+                return QString::fromLatin1(img.barcode.toByteArray().left(64).toHex(' '));
+            }
+            return img.barcode.toString().left(500);
+    }
+    return {};
+}
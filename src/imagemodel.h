@@ -0,0 +1,119 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef IMAGEMODEL_H
+#define IMAGEMODEL_H
+
+#include <KItinerary/PdfDocument>
+
+#include <QAbstractItemModel>
+#include <QCache>
+#include <QImage>
+#include <QThreadPool>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ExtractorRunner;
+
+/** Images of a PDF document, grouped by page, or a single image.
+ *  Only thumbnails are shown, and those are only decoded on the extractor worker thread once
+ *  a row actually becomes visible. Full resolution images are decoded on demand and kept in
+ *  a size-bounded cache.
+ *  Barcodes can be decoded for all images in parallel, results are shown inline and cached by image content.
+ */
+class ImageModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    explicit ImageModel(QObject *parent = nullptr);
+    ~ImageModel();
+
+    /** Image decoding happens on the worker thread of @p runner, as that's where the documents are used. */
+    void setRunner(ExtractorRunner *runner);
+
+    /** Shows the images of @p pdf, which is kept alive by @p owner. */
+    void setPdf(const KItinerary::PdfDocument *pdf, const std::shared_ptr<const void> &owner);
+    /** Shows the single image @p image. */
+    void setImage(const QImage &image);
+    void clear();
+
+    enum Column {
+        ImageColumn,
+        BarcodeColumn,
+        ColumnCount
+    };
+
+    /** Retrieves the full resolution image for @p index, decoding it if necessary.
+     *  @p callback is called once the image is available, which can be right away.
+     *  It gets a null image for indexes not referring to an image.
+     */
+    void requestImage(const QModelIndex &index, std::function<void(const QImage&)> &&callback);
+    /** Retrieves the barcode content of the image at @p index, decoding it if necessary.
+     *  @p callback gets a QString or QByteArray, or a null variant if there is no barcode.
+     */
+    void requestBarcode(const QModelIndex &index, std::function<void(const QVariant&)> &&callback);
+    /** Decodes the barcodes of all images in the background. */
+    void scanBarcodes();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+private:
+    struct Image {
+        KItinerary::PdfImage pdfImage;
+        QImage image; // only for non-PDF images
+        QImage thumbnail;
+        bool requested = false;
+        bool skippedByExtractor = false;
+
+        enum { BarcodeNotScanned, BarcodePending, BarcodeScanned } barcodeState = BarcodeNotScanned;
+        QVariant barcode;
+        qint64 barcodeElapsedNs = 0;
+        std::vector<std::function<void(const QVariant&)>> barcodeCallbacks;
+    };
+    struct BarcodeResult {
+        QVariant content;
+        qint64 elapsedNs = 0;
+    };
+    struct Page {
+        int firstImage = 0;
+        int imageCount = 0;
+    };
+
+    int imageNumber(const QModelIndex &index) const;
+    QModelIndex imageIndex(int image) const;
+    void requestThumbnail(int image) const;
+    /** Decodes image @p image on the worker thread and stores the result. */
+    void decode(int image, std::function<void(const QImage&)> &&done) const;
+    void decoded(int image, const QImage &img, const QImage &thumbnail, bool skippedByExtractor);
+    void fullImage(int image, std::function<void(const QImage&)> &&callback);
+    void scanBarcode(int image, std::function<void(const QVariant&)> &&callback);
+    void barcodeScanned(int image, const BarcodeResult &result);
+    QVariant barcodeData(const Image &img, int role) const;
+
+    ExtractorRunner *m_runner = nullptr;
+    std::shared_ptr<const void> m_owner;
+    mutable std::vector<Image> m_images;
+    std::vector<Page> m_pages; // empty when showing a single image
+    mutable QCache<int, QImage> m_fullImages;
+    // read by decoding jobs as well, so those can skip work for a document that is gone already
+    std::atomic<quint64> m_generation = 0;
+
+    // by image content, so this also applies to identical images in other documents
+    QCache<QByteArray, BarcodeResult> m_barcodeCache;
+    std::mutex m_barcodeCacheMutex;
+    QThreadPool m_barcodePool; // last, so pending jobs finish before anything they use is destroyed
+};
+
+#endif // IMAGEMODEL_H
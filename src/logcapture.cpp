@@ -0,0 +1,69 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "logcapture.h"
+
+#include <atomic>
+#include <cstring>
+
+static thread_local quint64 tl_currentRunId = 0;
+static std::atomic<quint64> s_nextRunId = 1;
+
+bool LogMessage::fromQtMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg, LogMessage &result)
+{
+    if (!context.category) {
+        return false;
+    }
+
+    if (std::strcmp(context.category, "js") == 0) {
+        // script debug output
+        result.msg = msg;
+        result.file = QString::fromUtf8(context.file);
+        result.function = QString::fromUtf8(context.function);
+        result.line = context.line;
+        result.type = type;
+    } else if (std::strcmp(context.category, "org.kde.kitinerary") == 0 && type == QtWarningMsg && msg.startsWith(QLatin1String("JS ERROR"))) {
+        // script engine errors
+        const auto idx1 = msg.indexOf(QLatin1String("]:"), 11);
+        if (idx1 > 0) {
+            result.file = msg.mid(11, idx1 - 11);
+        }
+        const auto idx2 = msg.indexOf(QLatin1Char(':'), idx1 + 2);
+        if (idx2 > idx1) {
+            result.line = QStringView(msg).mid(idx1 + 2, idx2 - idx1 - 2).toInt();
+            result.msg = msg.mid(idx2 + 1);
+        } else {
+            result.msg = msg;
+        }
+        result.type = QtFatalMsg;
+    } else {
+        return false;
+    }
+
+    result.runId = tl_currentRunId;
+    return true;
+}
+
+LogScope::LogScope(quint64 runId)
+    : m_prevRunId(tl_currentRunId)
+{
+    tl_currentRunId = runId;
+}
+
+LogScope::~LogScope()
+{
+    tl_currentRunId = m_prevRunId;
+}
+
+quint64 LogScope::currentRunId()
+{
+    return tl_currentRunId;
+}
+
+quint64 LogScope::createRunId()
+{
+    return s_nextRunId++;
+}
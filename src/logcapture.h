@@ -0,0 +1,53 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef LOGCAPTURE_H
+#define LOGCAPTURE_H
+
+#include <QString>
+#include <QtGlobal>
+
+/** Script console output or a script error, attributed to the extraction run that emitted it. */
+class LogMessage
+{
+public:
+    QString msg;
+    QString file;
+    QString function;
+    QtMsgType type = QtDebugMsg;
+    int line = 0;
+    /** See LogScope, 0 for messages emitted outside of any run. */
+    quint64 runId = 0;
+
+    /** Fills @p result from a Qt log message if that is script output.
+     *  Returns @c false for any other log message.
+     */
+    static bool fromQtMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg, LogMessage &result);
+};
+
+/** Attributes log messages emitted by the current thread to extraction run @p runId,
+ *  for the lifetime of this object.
+ *  Message handlers can be called on any thread concurrently, this lets them tell apart
+ *  the output of runs executed in parallel or in the background.
+ */
+class LogScope
+{
+public:
+    explicit LogScope(quint64 runId);
+    ~LogScope();
+    LogScope(const LogScope&) = delete;
+    LogScope& operator=(const LogScope&) = delete;
+
+    /** The run the current thread is working on, 0 if none. */
+    static quint64 currentRunId();
+    /** Returns a new process-wide unique run id. */
+    static quint64 createRunId();
+
+private:
+    quint64 m_prevRunId;
+};
+
+#endif // LOGCAPTURE_H
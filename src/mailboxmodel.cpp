@@ -0,0 +1,157 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "mailboxmodel.h"
+
+#include <KMime/Message>
+
+#include <KLocalizedString>
+
+#include <QFile>
+#include <QLocale>
+
+// headers beyond that are not interesting for the message list
+constexpr inline qsizetype MaxHeaderSize = 65536;
+
+MailboxModel::MailboxModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+MailboxModel::~MailboxModel() = default;
+
+void MailboxModel::setMailbox(const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile)
+{
+    beginResetModel();
+    m_data = data;
+    m_mappedFile = mappedFile;
+    m_offsets.clear();
+    m_headers.clear();
+
+    // single pass over the data, message bodies have "From " at the beginning of a line escaped
+    if (m_data.startsWith("From ")) {
+        m_offsets.push_back(0);
+    }
+    for (auto pos = m_data.indexOf("\nFrom "); pos >= 0; pos = m_data.indexOf("\nFrom ", pos + 1)) {
+        m_offsets.push_back(pos + 1);
+    }
+    if (!m_offsets.empty()) {
+        m_offsets.push_back(m_data.size());
+        m_headers.resize(m_offsets.size() - 1);
+    }
+    endResetModel();
+}
+
+void MailboxModel::clear()
+{
+    setMailbox({}, {});
+}
+
+bool MailboxModel::isMailbox(const QByteArray &data)
+{
+    return data.startsWith("From ");
+}
+
+QByteArray MailboxModel::messageData(int row) const
+{
+    if (row < 0 || row >= rowCount()) {
+        return {};
+    }
+
+    const auto envelopeEnd = m_data.indexOf('\n', m_offsets[row]);
+    const auto begin = envelopeEnd < 0 ? m_offsets[row + 1] : std::min(envelopeEnd + 1, m_offsets[row + 1]);
+    const auto size = m_offsets[row + 1] - begin;
+    // raw data is only safe to hand out when something independent of us keeps it alive
+    if (m_mappedFile) {
+        return QByteArray::fromRawData(m_data.constData() + begin, size);
+    }
+    return m_data.mid(begin, size);
+}
+
+std::shared_ptr<const QFile> MailboxModel::mappedFile() const
+{
+    return m_mappedFile;
+}
+
+int MailboxModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return (int)m_headers.size();
+}
+
+int MailboxModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+QVariant MailboxModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    if (role == Qt::DisplayRole) {
+        const auto &h = headers(index.row());
+        switch (index.column()) {
+            case SubjectColumn:
+                return h.subject;
+            case FromColumn:
+                return h.from;
+            case DateColumn:
+                return h.date;
+        }
+    }
+    return {};
+}
+
+QVariant MailboxModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+            case SubjectColumn:
+                return i18n("Subject");
+            case FromColumn:
+                return i18n("From");
+            case DateColumn:
+                return i18n("Date");
+        }
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+const MailboxModel::Headers& MailboxModel::headers(int row) const
+{
+    auto &h = m_headers[row];
+    if (h.parsed) {
+        return h;
+    }
+    h.parsed = true;
+
+    const auto msgData = messageData(row);
+    const auto head = QByteArrayView(msgData).first(std::min(msgData.size(), MaxHeaderSize));
+    auto headerEnd = head.size();
+    for (const auto separator : { QByteArrayView("\n\n"), QByteArrayView("\r\n\r\n") }) {
+        if (const auto idx = head.indexOf(separator); idx >= 0) {
+            headerEnd = std::min(headerEnd, idx);
+        }
+    }
+    KMime::Message msg;
+    msg.setHead(head.first(headerEnd).toByteArray());
+    msg.parse();
+    if (auto subject = msg.subject(false)) {
+        h.subject = subject->asUnicodeString();
+    }
+    if (auto from = msg.from(false)) {
+        h.from = from->asUnicodeString();
+    }
+    if (auto date = msg.date(false)) {
+        h.date = QLocale().toString(date->dateTime(), QLocale::ShortFormat);
+    }
+    return h;
+}
@@ -0,0 +1,69 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef MAILBOXMODEL_H
+#define MAILBOXMODEL_H
+
+#include <QAbstractTableModel>
+#include <QByteArray>
+
+#include <memory>
+#include <vector>
+
+class QFile;
+
+/** Messages of an mbox file.
+ *  Only an index of message offsets is built upfront, message headers are parsed on demand
+ *  for the rows actually shown, so this scales to mailboxes with many thousands of messages.
+ */
+class MailboxModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit MailboxModel(QObject *parent = nullptr);
+    ~MailboxModel();
+
+    enum Column {
+        SubjectColumn,
+        FromColumn,
+        DateColumn,
+        ColumnCount
+    };
+
+    /** Indexes the mbox content @p data.
+     *  @p mappedFile is kept alive as long as message data referring to it might be in use.
+     */
+    void setMailbox(const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile);
+    void clear();
+
+    /** Checks whether @p data looks like an mbox file. */
+    static bool isMailbox(const QByteArray &data);
+
+    /** Content of message @p row, without the mbox envelope line. Does not copy the message data. */
+    QByteArray messageData(int row) const;
+    std::shared_ptr<const QFile> mappedFile() const;
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+private:
+    struct Headers {
+        QString subject;
+        QString from;
+        QString date;
+        bool parsed = false;
+    };
+    const Headers& headers(int row) const;
+
+    QByteArray m_data;
+    std::shared_ptr<const QFile> m_mappedFile;
+    std::vector<qsizetype> m_offsets; // start of each message, plus the end of the last one
+    mutable std::vector<Headers> m_headers;
+};
+
+#endif // MAILBOXMODEL_H
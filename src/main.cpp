@@ -4,10 +4,18 @@
     SPDX-License-Identifier: LGPL-2.0-or-later
 */
 
+#include "barcodebenchmark.h"
+#include "batchextractor.h"
 #include "mainwindow.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QFile>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
 int main(int argc, char **argv)
 {
@@ -15,13 +23,89 @@ int main(int argc, char **argv)
     QCoreApplication::setOrganizationName(QStringLiteral("KDE"));
     QCoreApplication::setApplicationName(QStringLiteral("kitinerary-workbench"));
 
-    QApplication app(argc, argv);
+    // batch mode must work without a display, so we need to know about it before creating the application
+    const auto batchMode = std::any_of(argv + 1, argv + argc, [](const char *arg) {
+        return std::strcmp(arg, "--batch") == 0 || std::strcmp(arg, "--barcode-benchmark") == 0;
+    });
+    std::unique_ptr<QCoreApplication> app(batchMode ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
 
     QCommandLineParser parser;
     parser.addHelpOption();
     parser.addVersionOption();
-    parser.addPositionalArgument(QStringLiteral("file"), QStringLiteral("Input file to open."));
-    parser.process(app);
+    parser.addPositionalArgument(QStringLiteral("file"), QStringLiteral("Input file to open, or files and directories to process in batch mode."));
+    QCommandLineOption batchOpt(QStringLiteral("batch"), QStringLiteral("Extract all given files and directories without UI, writing JSON lines to the output."));
+    parser.addOption(batchOpt);
+    QCommandLineOption barcodeBenchmarkOpt(QStringLiteral("barcode-benchmark"), QStringLiteral("Decode barcodes in all given image files, PDF files and directories with different decoder hints without UI, writing a report to the output."));
+    parser.addOption(barcodeBenchmarkOpt);
+    QCommandLineOption jobsOpt(QStringLiteral("jobs"), QStringLiteral("Number of parallel workers in batch or benchmark mode."), QStringLiteral("count"), QString::number(QThread::idealThreadCount()));
+    parser.addOption(jobsOpt);
+    QCommandLineOption outputOpt(QStringLiteral("output"), QStringLiteral("File to write batch results to, standard output by default."), QStringLiteral("file"));
+    parser.addOption(outputOpt);
+    QCommandLineOption cacheOpt(QStringLiteral("cache"), QStringLiteral("Directory for caching batch results, so unchanged inputs are not extracted again."), QStringLiteral("directory"));
+    parser.addOption(cacheOpt);
+    QCommandLineOption senderOpt(QStringLiteral("sender"), QStringLiteral("Sender address for the extraction context."), QStringLiteral("address"));
+    parser.addOption(senderOpt);
+    QCommandLineOption contextDateOpt(QStringLiteral("context-date"), QStringLiteral("Context date in ISO 8601 format, today by default."), QStringLiteral("date"));
+    parser.addOption(contextDateOpt);
+    QCommandLineOption noRasterOpt(QStringLiteral("no-full-page-raster-images"), QStringLiteral("Do not extract full page raster images from PDF documents."));
+    parser.addOption(noRasterOpt);
+    QCommandLineOption separateProcessOpt(QStringLiteral("separate-process"), QStringLiteral("Perform extraction out of process."));
+    parser.addOption(separateProcessOpt);
+    QCommandLineOption acceptIncompleteOpt(QStringLiteral("accept-incomplete"), QStringLiteral("Also accept incomplete elements during validation."));
+    parser.addOption(acceptIncompleteOpt);
+    parser.process(*app);
+
+    if (batchMode) {
+        QFile output;
+        if (parser.isSet(outputOpt)) {
+            output.setFileName(parser.value(outputOpt));
+            if (!output.open(QFile::WriteOnly | QFile::Truncate)) {
+                qCritical("Failed to open output file: %s", qPrintable(output.errorString()));
+                return 1;
+            }
+        } else {
+            output.open(stdout, QFile::WriteOnly);
+        }
+
+        if (parser.isSet(barcodeBenchmarkOpt)) {
+            BarcodeBenchmark benchmark;
+            benchmark.setJobCount(parser.value(jobsOpt).toInt());
+            benchmark.setOutput(&output);
+            for (const auto &path : parser.positionalArguments()) {
+                benchmark.addPath(path);
+            }
+            return benchmark.exec();
+        }
+
+        ExtractorInput settings;
+        settings.sender = parser.value(senderOpt);
+        if (parser.isSet(contextDateOpt)) {
+            settings.contextDate = QDateTime::fromString(parser.value(contextDateOpt), Qt::ISODate);
+            if (!settings.contextDate.isValid()) {
+                qCritical("Invalid context date '%s', expected ISO 8601 format.", qPrintable(parser.value(contextDateOpt)));
+                return 1;
+            }
+        } else {
+            settings.contextDate = QDateTime(QDate::currentDate(), QTime());
+        }
+        if (parser.isSet(noRasterOpt)) {
+            settings.hints &= ~KItinerary::ExtractorEngine::ExtractFullPageRasterImages;
+        }
+        settings.separateProcess = parser.isSet(separateProcessOpt);
+
+        BatchExtractor batch;
+        batch.setSettings(settings);
+        batch.setAcceptCompleteOnly(!parser.isSet(acceptIncompleteOpt));
+        batch.setJobCount(parser.value(jobsOpt).toInt());
+        batch.setOutput(&output);
+        if (parser.isSet(cacheOpt)) {
+            batch.setCacheDirectory(parser.value(cacheOpt));
+        }
+        for (const auto &path : parser.positionalArguments()) {
+            batch.addPath(path);
+        }
+        return batch.exec();
+    }
 
     auto mainWindow = new MainWindow;
     mainWindow->show();
@@ -29,5 +113,5 @@ int main(int argc, char **argv)
     if (parser.positionalArguments().size() == 1)
         mainWindow->openFile(parser.positionalArguments().at(0));
 
-    return app.exec();
+    return app->exec();
 }
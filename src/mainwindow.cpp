@@ -9,20 +9,21 @@
 #include "attributemodel.h"
 #include "documentmodel.h"
 #include "dommodel.h"
+#include "gadgetitemmodel.h"
+#include "hexview.h"
+#include "imagemodel.h"
+#include "mailboxmodel.h"
+#include "profilemodel.h"
 #include "settingsdialog.h"
 #include "standarditemmodelhelper.h"
+#include "textdocumentupdater.h"
+#include "xpathcorpusdialog.h"
 
-#include <KItinerary/BarcodeDecoder>
 #include <KItinerary/BERElement>
-#include <KItinerary/CalendarHandler>
-#include <KItinerary/ExtractorPostprocessor>
-#include <KItinerary/ExtractorRepository>
 #include <KItinerary/ExtractorResult>
-#include <KItinerary/ExtractorValidator>
 #include <KItinerary/HtmlDocument>
 #include <KItinerary/IataBcbp>
 #include <KItinerary/JsonLdDocument>
-#include <KItinerary/MergeUtil>
 #include <KItinerary/PdfDocument>
 #include <KItinerary/Reservation>
 #include <KItinerary/ELBTicket>
@@ -35,12 +36,6 @@
 
 #include <KPkPass/Pass>
 
-#include <KCalendarCore/Event>
-#include <KCalendarCore/ICalFormat>
-#include <KCalendarCore/MemoryCalendar>
-
-#include <KMime/Message>
-
 #include <KTextEditor/Document>
 #include <KTextEditor/View>
 #include <KTextEditor/Editor>
@@ -54,77 +49,74 @@
 #include <QBuffer>
 #include <QClipboard>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QFontMetrics>
 #include <QHBoxLayout>
 #include <QImage>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLocale>
 #include <QMenu>
 #include <QMetaEnum>
 #include <QMetaObject>
 #include <QMimeData>
 #include <QSettings>
+#include <QSortFilterProxyModel>
 #include <QStandardItemModel>
+#include <QStatusBar>
 #include <QStringEncoder>
+#include <QThread>
+#include <QTimer>
 #include <QToolBar>
+#include <QToolButton>
 
-#include <cctype>
+#include <algorithm>
 #include <cstring>
 
 Q_DECLARE_METATYPE(KItinerary::Internal::OwnedPtr<KItinerary::HtmlDocument>)
 Q_DECLARE_METATYPE(KItinerary::Internal::OwnedPtr<KItinerary::PdfDocument>)
 
-static QVector<QVector<QVariant>> batchReservations(const QVector<QVariant> &reservations)
-{
-    using namespace KItinerary;
-
-    QVector<QVector<QVariant>> batches;
-    QVector<QVariant> batch;
-
-    for (const auto &res : reservations) {
-        if (batch.isEmpty()) {
-            batch.push_back(res);
-            continue;
-        }
-
-        if (MergeUtil::isSameIncidence(res, batch.at(0))) {
-            batch.push_back(res);
-            continue;
-        }
-
-        batches.push_back(batch);
-        batch.clear();
-        batch.push_back(res);
-    }
-
-    if (!batch.isEmpty()) {
-        batches.push_back(batch);
-    }
-    return batches;
-}
-
 MainWindow::MainWindow(QWidget* parent)
     : KXmlGuiWindow(parent)
     , ui(new Ui::MainWindow)
     , m_extractorDocModel(new DocumentModel(this))
-    , m_imageModel(new QStandardItemModel(this))
+    , m_imageModel(new ImageModel(this))
     , m_domModel(new DOMModel(this))
     , m_attrModel(new AttributeModel(this))
-    , m_iataBcbpModel(new QStandardItemModel(this))
-    , m_eraSsbModel(new QStandardItemModel(this))
-    , m_vdvModel(new QStandardItemModel(this))
+    , m_iataBcbpModel(new GadgetItemModel(this))
+    , m_eraSsbModel(new GadgetItemModel(this))
+    , m_vdvModel(new GadgetItemModel(this))
+    , m_profileModel(new ProfileModel(this))
+    , m_mailboxModel(new MailboxModel(this))
+    , m_runner(new ExtractorRunner(this))
+    , m_extractTimer(new QTimer(this))
 {
     ui->setupUi(this);
     ui->contextDate->setDateTime(QDateTime(QDate::currentDate(), QTime()));
     setCentralWidget(ui->mainSplitter);
 
-    m_engine.setHints(KItinerary::ExtractorEngine::ExtractGenericIcalEvents | KItinerary::ExtractorEngine::ExtractFullPageRasterImages);
+    // coalesce bursts of input changes (e.g. typing) into a single extraction run
+    m_extractTimer->setSingleShot(true);
+    m_extractTimer->setInterval(std::chrono::milliseconds(250));
+    connect(m_extractTimer, &QTimer::timeout, this, &MainWindow::runExtractor);
+    connect(m_runner, &ExtractorRunner::started, this, [this]() {
+        statusBar()->showMessage(i18n("Extracting..."));
+    });
+    connect(m_runner, &ExtractorRunner::finished, this, &MainWindow::applyRun);
 
     connect(ui->senderBox, &QComboBox::currentTextChanged, this, &MainWindow::sourceChanged);
     connect(ui->contextDate, &QDateTimeEdit::dateTimeChanged, this, &MainWindow::sourceChanged);
     connect(ui->fileRequester, &KUrlRequester::textChanged, this, &MainWindow::urlChanged);
-    connect(ui->extractorWidget, &ExtractorEditorWidget::extractorChanged, this, &MainWindow::sourceChanged);
+    connect(ui->extractorWidget, &ExtractorEditorWidget::extractorChanged, this, &MainWindow::extractorChanged);
+    connect(ui->extractorWidget, &ExtractorEditorWidget::extractorsModified, this, &MainWindow::extractorsModified);
+    ui->extractorWidget->setRunner(m_runner);
+    connect(ui->extractorWidget, &ExtractorEditorWidget::repositoryAboutToReload, m_runner, &ExtractorRunner::waitForDone);
+    connect(ui->extractorWidget, &ExtractorEditorWidget::repositoryAboutToReload, this, [this]() {
+        m_runner->cache()->invalidateExtractorFingerprint();
+    });
 
     auto editor = KTextEditor::Editor::instance();
 
@@ -132,6 +124,25 @@ MainWindow::MainWindow(QWidget* parent)
     connect(m_sourceDoc, &KTextEditor::Document::textChanged, this, &MainWindow::sourceChanged);
     m_sourceView = m_sourceDoc->createView(nullptr);
     ui->sourceTab->layout()->addWidget(m_sourceView);
+    m_hexView = new HexView(ui->sourceTab);
+    ui->sourceTab->layout()->addWidget(m_hexView);
+    m_hexView->hide();
+
+    ui->mailboxWidget->hide();
+    ui->mailboxView->setModel(m_mailboxModel);
+    ui->mailboxView->header()->setSectionResizeMode(MailboxModel::SubjectColumn, QHeaderView::Stretch);
+    connect(ui->mailboxView->selectionModel(), &QItemSelectionModel::currentRowChanged, this, [this](const QModelIndex &current) {
+        if (!current.isValid()) {
+            return;
+        }
+        m_data = m_mailboxModel->messageData(current.row());
+        m_mappedFile = m_mailboxModel->mappedFile();
+        sourceChanged();
+    });
+    connect(ui->mailboxPrefetch, &QSpinBox::valueChanged, this, [this](int count) {
+        // keep the prefetched messages around, next to the current one
+        m_runner->cache()->setCapacity(std::max<std::size_t>(8, 2 * count + 2));
+    });
 
     m_preprocDoc = editor->createDocument(nullptr);
     auto view = m_preprocDoc->createView(nullptr);
@@ -149,20 +160,19 @@ MainWindow::MainWindow(QWidget* parent)
         setCurrentDocumentNode(idx.data(Qt::UserRole).value<KItinerary::ExtractorDocumentNode>());
     });
 
-    m_imageModel->setHorizontalHeaderLabels({i18n("Image")});
+    m_imageModel->setRunner(m_runner);
     ui->imageView->setModel(m_imageModel);
+    ui->imageView->header()->setSectionResizeMode(ImageModel::ImageColumn, QHeaderView::ResizeToContents);
     connect(ui->imageView, &QWidget::customContextMenuRequested, this, &MainWindow::imageContextMenu);
 
     auto domFilterModel = new DOMFilterModel(this);
-    domFilterModel->setRecursiveFilteringEnabled(true);
-    domFilterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
     domFilterModel->setSourceModel(m_domModel);
-    connect(domFilterModel, &QSortFilterProxyModel::layoutChanged, ui->domView, &QTreeView::expandAll);
-    connect(domFilterModel, &QSortFilterProxyModel::rowsRemoved, ui->domView, &QTreeView::expandAll);
-    connect(domFilterModel, &QSortFilterProxyModel::rowsInserted, ui->domView, &QTreeView::expandAll);
     ui->domView->setModel(domFilterModel);
     ui->domView->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    connect(ui->domSearchLine, &QLineEdit::textChanged, domFilterModel, &QSortFilterProxyModel::setFilterFixedString);
+    connect(ui->domSearchLine, &QLineEdit::textChanged, this, [this, domFilterModel](const QString &text) {
+        domFilterModel->setSearchText(text);
+        expandDomTree();
+    });
     ui->attributeView->setModel(m_attrModel);
     ui->attributeView->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
     connect(ui->domView->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this](const QItemSelection &selection) {
@@ -179,17 +189,14 @@ MainWindow::MainWindow(QWidget* parent)
     });
     ui->domSplitter->setStretchFactor(0, 5);
     ui->domSplitter->setStretchFactor(1, 1);
-    connect(ui->xpathEdit, &QLineEdit::editingFinished, this, [this]() {
-        if (!m_domModel->document()) {
-            return;
-        }
-        const auto res = m_domModel->document()->eval(ui->xpathEdit->text());
-        if (!res.canConvert<QVariantList>()) { // TODO show this properly in the UI somehow
-            qDebug() << "XPath result:" << res;
-        }
-        m_domModel->setHighlightNodeSet(res.value<QVariantList>());
-        ui->domView->viewport()->update(); // dirty, but easier than triggering a proper full model update
-    });
+    connect(ui->xpathEdit, &QLineEdit::editingFinished, this, &MainWindow::evaluateXPath);
+    connect(ui->xpathPrevButton, &QToolButton::clicked, this, [this]() { selectXPathMatch(m_xpathMatch - 1); });
+    connect(ui->xpathNextButton, &QToolButton::clicked, this, [this]() { selectXPathMatch(m_xpathMatch + 1); });
+    ui->xpathPrevButton->setEnabled(false);
+    ui->xpathNextButton->setEnabled(false);
+    connect(ui->xpathCorpusButton, &QToolButton::clicked, this, &MainWindow::evaluateXPathCorpus);
+    // evaluating on sample directories has its own workers, this only waits for those
+    m_xpathCorpusPool.setMaxThreadCount(1);
 
     m_iataBcbpModel->setHorizontalHeaderLabels({i18n("Field"), i18n("Value")});
     ui->iataBcbpView->setModel(m_iataBcbpModel);
@@ -202,36 +209,65 @@ MainWindow::MainWindow(QWidget* parent)
     m_vdvModel->setHorizontalHeaderLabels({i18n("Field"), i18n("Value")});
     ui->vdvView->setModel(m_vdvModel);
     ui->vdvView->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    connect(ui->vdvView->selectionModel(), &QItemSelectionModel::currentChanged, this, [this](const QModelIndex &current) {
+        const auto idx = current.siblingAtColumn(0);
+        if (idx.data(HexView::OffsetRole).isValid()) {
+            ui->vdvHexView->setHighlight(idx.data(HexView::OffsetRole).toLongLong(), idx.data(HexView::SizeRole).toLongLong());
+        } else {
+            ui->vdvHexView->clearHighlight();
+        }
+    });
+    ui->vdvSplitter->setStretchFactor(0, 3);
+    ui->vdvSplitter->setStretchFactor(1, 1);
+
+    ui->profileView->setModel(m_profileModel);
+    ui->profileView->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    connect(m_profileModel, &QAbstractItemModel::rowsInserted, ui->profileView, [this](const QModelIndex &parent, int first) {
+        if (!parent.isValid()) {
+            ui->profileView->expand(m_profileModel->index(first, 0));
+        }
+    });
 
     m_nodeResultDoc = editor->createDocument(nullptr);
     m_nodeResultDoc->setMode(QStringLiteral("JSON"));
+    m_nodeResultUpdater = new TextDocumentUpdater(m_nodeResultDoc);
     view = m_nodeResultDoc->createView(nullptr);
     layout = new QHBoxLayout(ui->nodeResultTab);
     layout->addWidget(view);
 
     m_outputDoc = editor->createDocument(nullptr);
     m_outputDoc->setMode(QStringLiteral("JSON"));
+    m_outputUpdater = new TextDocumentUpdater(m_outputDoc);
     view = m_outputDoc->createView(nullptr);
     layout = new QHBoxLayout(ui->outputTab);
     layout->addWidget(view);
 
     m_postprocDoc = editor->createDocument(nullptr);
     m_postprocDoc->setMode(QStringLiteral("JSON"));
+    m_postprocUpdater = new TextDocumentUpdater(m_postprocDoc);
     view = m_postprocDoc->createView(nullptr);
     layout = new QHBoxLayout(ui->postprocTab);
     layout->addWidget(view);
 
     m_validatedDoc = editor->createDocument(nullptr);
     m_validatedDoc->setMode(QStringLiteral("JSON"));
+    m_validatedUpdater = new TextDocumentUpdater(m_validatedDoc);
     view = m_validatedDoc->createView(nullptr);
     ui->validatedTab->layout()->addWidget(view);
-    connect(ui->acceptCompleteOnly, &QCheckBox::toggled, this, &MainWindow::sourceChanged);
+    m_outputStages.setAcceptCompleteOnly(ui->acceptCompleteOnly->isChecked());
+    connect(ui->acceptCompleteOnly, &QCheckBox::toggled, this, [this](bool checked) {
+        // only affects the validation stage, no need to re-run the extractor for this
+        m_outputStages.setAcceptCompleteOnly(checked);
+        invalidateOutputTabs(OutputStages::Validated);
+        updateOutputTab();
+    });
 
     m_icalDoc = editor->createDocument(nullptr);
     m_icalDoc->setMode(QStringLiteral("vCard, vCalendar, iCalendar"));
     view = m_icalDoc->createView(nullptr);
     layout = new QHBoxLayout(ui->icalTab);
     layout->addWidget(view);
+    connect(ui->outputTabWidget, &QTabWidget::currentChanged, this, &MainWindow::updateOutputTab);
 
     connect(ui->consoleWidget, &ConsoleOutputWidget::navigateToSource, ui->extractorWidget, &ExtractorEditorWidget::navigateToSource);
     connect(ui->consoleWidget, &ConsoleOutputWidget::navigateToSource, this, [this]() {
@@ -244,50 +280,70 @@ MainWindow::MainWindow(QWidget* parent)
     settings.beginGroup(QLatin1String("SenderHistory"));
     ui->senderBox->addItems(settings.value(QLatin1String("History")).toStringList());
     ui->senderBox->setCurrentText(QString());
+    settings.endGroup();
 
-    connect(ui->actionExtractorRun, &QAction::triggered, this, &MainWindow::sourceChanged);
+    // explicitly requested runs always bypass the cache
+    connect(ui->actionExtractorRun, &QAction::triggered, this, [this]() { startExtraction(ExtractorRunner::BypassCache); });
+    connect(ui->actionExtractorClearCache, &QAction::triggered, this, [this]() {
+        m_runner->waitForDone();
+        m_runner->cache()->clear();
+    });
     connect(ui->actionExtractorReloadRepository, &QAction::triggered, this, [this]() {
-        KItinerary::ExtractorRepository repo;
-        repo.reload();
-        ui->extractorWidget->reloadExtractors();
+        statusBar()->showMessage(ui->extractorWidget->reloadRepository(), 5000);
     });
     connect(ui->actionInputFromClipboard, &QAction::triggered, this, &MainWindow::loadFromClipboard);
     connect(ui->actionInputClear, &QAction::triggered, this, [this]() {
         ui->fileRequester->clear();
+        clearMailbox();
         m_sourceDoc->clear();
         m_sourceView->show();
+        setHexViewData({}, {});
         sourceChanged();
     });
-    connect(ui->actionSeparateProcess, &QAction::toggled, this, [this](bool checked) {
-        clearEngine();
-        m_engine.setUseSeparateProcess(checked);
-        sourceChanged();
-    });
+    connect(ui->actionSeparateProcess, &QAction::toggled, this, &MainWindow::sourceChanged);
     connect(ui->actionFullPageRasterImages, &QAction::toggled, this, [this](bool checked) {
-        clearEngine();
         if (checked) {
-            m_engine.setHints(m_engine.hints() | KItinerary::ExtractorEngine::ExtractFullPageRasterImages);
+            m_engineHints |= KItinerary::ExtractorEngine::ExtractFullPageRasterImages;
         } else {
-            m_engine.setHints(m_engine.hints() & ~KItinerary::ExtractorEngine::ExtractFullPageRasterImages);
+            m_engineHints &= ~KItinerary::ExtractorEngine::ExtractFullPageRasterImages;
         }
         sourceChanged();
     });
+    connect(ui->actionDiskCache, &QAction::toggled, this, [this](bool checked) {
+        m_runner->cache()->setDiskCachePath(checked ? ResultCache::defaultDiskCachePath() : QString());
+    });
+    connect(ui->actionHighlightChanges, &QAction::toggled, this, [this](bool checked) {
+        for (auto updater : { m_nodeResultUpdater, m_outputUpdater, m_postprocUpdater, m_validatedUpdater }) {
+            updater->setHighlightChanges(checked);
+        }
+    });
     connect(ui->actionSettingsConfigure, &QAction::triggered, this, [this]() {
+        m_runner->waitForDone();
         SettingsDialog dlg(this);
         if (dlg.exec() == QDialog::Accepted) {
+            loadSettings();
             ui->actionExtractorReloadRepository->trigger();
         }
     });
     actionCollection()->addAction(QStringLiteral("extractor_run"), ui->actionExtractorRun);
     actionCollection()->addAction(QStringLiteral("extractor_reload_repository"), ui->actionExtractorReloadRepository);
+    actionCollection()->addAction(QStringLiteral("extractor_clear_cache"), ui->actionExtractorClearCache);
     actionCollection()->addAction(QStringLiteral("input_from_clipboard"), ui->actionInputFromClipboard);
     actionCollection()->addAction(QStringLiteral("input_clear"), ui->actionInputClear);
     actionCollection()->addAction(QStringLiteral("file_quit"), KStandardAction::quit(QApplication::instance(), &QApplication::closeAllWindows, this));
     actionCollection()->addAction(QStringLiteral("options_configure"), ui->actionSettingsConfigure);
     actionCollection()->addAction(QStringLiteral("settings_separate_process"), ui->actionSeparateProcess);
     actionCollection()->addAction(QStringLiteral("settings_full_page_raster_images"), ui->actionFullPageRasterImages);
+    actionCollection()->addAction(QStringLiteral("settings_disk_cache"), ui->actionDiskCache);
+    actionCollection()->addAction(QStringLiteral("settings_highlight_changes"), ui->actionHighlightChanges);
+    actionCollection()->addAction(QStringLiteral("settings_reuse_document_tree"), ui->actionReuseDocumentTree);
     ui->extractorWidget->registerActions(actionCollection());
 
+    settings.beginGroup(QLatin1String("ResultCache"));
+    ui->actionDiskCache->setChecked(settings.value(QLatin1String("DiskCache"), false).toBool());
+    settings.endGroup();
+    loadSettings();
+
     setupGUI(Default, QStringLiteral("ui.rc"));
 }
 
@@ -303,7 +359,16 @@ MainWindow::~MainWindow()
     settings.setValue(QLatin1String("History"), history);
     settings.endGroup();
 
+    settings.beginGroup(QLatin1String("ResultCache"));
+    settings.setValue(QLatin1String("DiskCache"), ui->actionDiskCache->isChecked());
+    settings.endGroup();
+
+    if (m_xpathCorpus) {
+        m_xpathCorpus->cancel();
+    }
     clearEngine();
+    // pending image decoding jobs refer to m_imageModel
+    m_runner->waitForDone();
 }
 
 void MainWindow::openFile(const QString &file)
@@ -311,23 +376,125 @@ void MainWindow::openFile(const QString &file)
     ui->fileRequester->setText(file);
 }
 
+void MainWindow::loadSettings()
+{
+    QSettings settings;
+    settings.beginGroup(QLatin1String("DocumentTree"));
+    m_autoExpandDepth = settings.value(QLatin1String("AutoExpandDepth"), SettingsDialog::DefaultAutoExpandDepth).toInt();
+}
+
+void MainWindow::expandTree(QTreeView *view)
+{
+    // expanding everything would materialize the entire tree, which can be huge for mailboxes, large PDFs, HTML or ASN.1 ticket content
+    if (m_autoExpandDepth < 0) {
+        view->expandAll();
+    } else {
+        view->expandToDepth(m_autoExpandDepth);
+    }
+}
+
+void MainWindow::expandDomTree()
+{
+    // search results only contain matches and their ancestors, so expanding all of them is cheap
+    if (ui->domSearchLine->text().isEmpty()) {
+        expandTree(ui->domView);
+    } else {
+        ui->domView->expandAll();
+    }
+}
+
 void MainWindow::clearEngine()
 {
     // ensure we hold no references to document nodes anymore
     ui->documentTreeView->clearSelection();
     m_currentNode = {};
-    StandardItemModelHelper::clearContent(m_extractorDocModel);
-    m_engine.clear();
+    m_extractorDocModel->clear();
+    m_imageModel->clear();
+    m_domModel->setDocument(nullptr);
+    evaluateXPath();
+    m_attrModel->setElement({});
+    ui->uic9183Widget->clear();
+    ui->extractorWidget->setCurrentRun({});
+    m_currentRun.reset();
 }
 
 void MainWindow::sourceChanged()
 {
+    // whatever is still running is outdated now
+    m_runner->cancel();
+    m_extractTimer->start();
+}
+
+void MainWindow::extractorChanged()
+{
+    m_runner->cache()->invalidateExtractorFingerprint();
+    // unless the input changed as well, only the extractors need to run again on the existing document tree
+    if (!ui->actionReuseDocumentTree->isChecked() || m_extractTimer->isActive() || !m_currentRun || !m_currentRun->engine) {
+        sourceChanged();
+        return;
+    }
+
+    auto run = m_currentRun;
     clearEngine();
+    m_runner->rerunScripts(run);
+}
 
-    StandardItemModelHelper::clearContent(m_imageModel);
-    ui->uic9183Widget->clear();
-    ui->consoleWidget->clear();
-    using namespace KItinerary;
+void MainWindow::extractorsModified(const std::vector<ExtractorMetaData> &extractors, const std::vector<ExtractorMetaData> &previousExtractors, bool metaDataChanged)
+{
+    // affects cached results of other inputs as well
+    m_runner->cache()->invalidateExtractorFingerprint();
+    if (!m_currentRun) {
+        return;
+    }
+
+    // the reloaded repository can't tell anymore whether the previous version of an extractor applied to
+    // the current input, e.g. one that got removed or changed its MIME type, so assume it did
+    if (!previousExtractors.empty()) {
+        extractorChanged();
+        return;
+    }
+
+    const auto &usedExtractor = m_currentRun->usedExtractor;
+    if (std::any_of(extractors.begin(), extractors.end(), [&usedExtractor](const auto &extractor) { return extractor.name == usedExtractor; })) {
+        extractorChanged();
+        return;
+    }
+    if (!m_currentRun->engine) {
+        return;
+    }
+
+    // whether any other of those applies needs all filters evaluated on the entire document tree, which
+    // is only worth it here, and has to happen on the thread the document tree belongs to
+    m_runner->post([this, run = m_currentRun, extractors, metaDataChanged]() {
+        auto analysis = ExtractorPipeline::analyzeDocumentTree(*run->engine);
+        QMetaObject::invokeMethod(this, [this, run, extractors, metaDataChanged, analysis = std::move(analysis)]() {
+            if (run != m_currentRun) {
+                return; // superseded by a run using the modified extractors already
+            }
+            const auto isRelevant = std::any_of(extractors.begin(), extractors.end(), [&analysis, metaDataChanged](const auto &extractor) {
+                if (analysis.applicableExtractors.contains(extractor.name)) {
+                    return true;
+                }
+                // changed filters might match the current input now
+                return metaDataChanged && std::any_of(extractor.filters.begin(), extractor.filters.end(), [&analysis](const auto &filter) {
+                    return analysis.documentMimeTypes.contains(filter.mimeType());
+                });
+            });
+            if (isRelevant) {
+                extractorChanged();
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::runExtractor()
+{
+    startExtraction(ExtractorRunner::UseCache);
+}
+
+void MainWindow::startExtraction(ExtractorRunner::CachePolicy cachePolicy)
+{
+    m_extractTimer->stop();
 
     if (m_sourceView->isVisible()) {
         QStringEncoder codec(m_sourceDoc->encoding().toUtf8().constData());
@@ -335,52 +502,146 @@ void MainWindow::sourceChanged()
             codec = QStringEncoder(QStringEncoder::System);
         }
         m_data = codec.encode(m_sourceDoc->text());
+        m_mappedFile.reset();
+    }
+
+    ExtractorInput input;
+    input.data = m_data;
+    input.mappedFile = m_mappedFile;
+    input.fileName = ui->fileRequester->url().path();
+    input.sender = ui->senderBox->currentText();
+    input.contextDate = ui->contextDate->dateTime();
+    input.hints = m_engineHints;
+    input.separateProcess = ui->actionSeparateProcess->isChecked();
+    if (m_mailboxModel->rowCount() > 0) {
+        // the message on its own must not be mistaken for an mbox file based on its name
+        input.fileName += QLatin1Char('#') + QString::number(ui->mailboxView->currentIndex().row() + 1);
+    }
+    m_runner->run(input, cachePolicy);
+    prefetchMailbox(input);
+}
+
+void MainWindow::prefetchMailbox(const ExtractorInput &input)
+{
+    const auto row = ui->mailboxView->currentIndex().row();
+    if (m_mailboxModel->rowCount() == 0 || row < 0) {
+        return;
+    }
+
+    // closest neighbours first, that's where the user is most likely to go next
+    std::vector<ExtractorInput> inputs;
+    const auto fileName = ui->fileRequester->url().path();
+    for (int i = 1; i <= ui->mailboxPrefetch->value(); ++i) {
+        for (const auto r : { row + i, row - i }) {
+            if (r < 0 || r >= m_mailboxModel->rowCount()) {
+                continue;
+            }
+            auto neighbour = input;
+            neighbour.data = m_mailboxModel->messageData(r);
+            neighbour.fileName = fileName + QLatin1Char('#') + QString::number(r + 1);
+            inputs.push_back(std::move(neighbour));
+        }
+    }
+    m_runner->prefetch(inputs);
+}
+
+void MainWindow::applyRun(const std::shared_ptr<ExtractorRun> &run, StageProfile profile)
+{
+    clearEngine();
+    m_currentRun = run;
+    statusBar()->clearMessage();
+
+    using namespace KItinerary;
+    ui->extractorWidget->showExtractor(run->usedExtractor);
+    ui->consoleWidget->setRunId(run->id);
+    ui->extractorWidget->setCurrentRun(run);
+
+    if (run->engine) {
+        {
+            StageProfile::Measurement m(&profile, QStringLiteral("DocumentModel::setRootNode"));
+            m_extractorDocModel->setRootNode(run->engine->rootDocumentNode());
+            expandTree(ui->documentTreeView);
+        }
+        StageProfile::Measurement m(&profile, QStringLiteral("setCurrentDocumentNode"));
+        setCurrentDocumentNode(run->engine->rootDocumentNode());
+    } else {
+        // result from the on-disk cache, there is no document tree for this
+        setCurrentDocumentNode({});
+        statusBar()->showMessage(i18n("Result loaded from cache, re-run the extractor to inspect the input document."));
+    }
+
+    m_outputStages.setRun(run);
+    invalidateOutputTabs(OutputStages::Extractor);
+
+    const auto fileName = QFileInfo(run->input.fileName).fileName();
+    m_profileModel->addRun(fileName.isEmpty() ? i18n("<text input>") : fileName, profile);
+    updateOutputTab();
+}
+
+void MainWindow::invalidateOutputTabs(OutputStages::Stage stage)
+{
+    switch (stage) {
+        case OutputStages::Extractor:
+            m_staleOutputTabs |= 1 << ExtractorOutputTab;
+            [[fallthrough]];
+        case OutputStages::Postprocessed:
+            m_staleOutputTabs |= 1 << PostprocessorTab;
+            [[fallthrough]];
+        case OutputStages::Validated:
+            m_staleOutputTabs |= 1 << ValidatedTab;
+            [[fallthrough]];
+        case OutputStages::ICal:
+            m_staleOutputTabs |= 1 << ICalTab;
+    }
+}
+
+void MainWindow::updateOutputTab()
+{
+    using namespace KItinerary;
+
+    const auto tab = ui->outputTabWidget->currentIndex();
+    if (!m_currentRun || (m_staleOutputTabs & (1 << tab)) == 0) {
+        return;
+    }
+    m_staleOutputTabs &= ~(1 << tab);
+
+    // downstream stages are only computed when their tab is actually shown
+    StageProfile profile;
+    const auto revision = m_currentRun->outputStages.revision();
+    switch (tab) {
+        case ExtractorOutputTab:
+        {
+            StageProfile::Measurement m(&profile, QStringLiteral("JSON serialization"));
+            m_outputUpdater->setText(QString::fromUtf8(QJsonDocument(m_currentRun->extractorOutput).toJson()));
+            break;
+        }
+        case PostprocessorTab:
+        {
+            const auto &result = m_outputStages.postprocessed(&profile);
+            StageProfile::Measurement m(&profile, QStringLiteral("JSON serialization"));
+            m_postprocUpdater->setText(QString::fromUtf8(QJsonDocument(JsonLdDocument::toJson(result)).toJson()));
+            break;
+        }
+        case ValidatedTab:
+        {
+            const auto &result = m_outputStages.validated(&profile);
+            StageProfile::Measurement m(&profile, QStringLiteral("JSON serialization"));
+            m_validatedUpdater->setText(QString::fromUtf8(QJsonDocument(JsonLdDocument::toJson(result)).toJson()));
+            break;
+        }
+        case ICalTab:
+            m_icalDoc->setText(m_outputStages.iCal(&profile));
+            break;
     }
 
-    m_contextMsg = std::make_unique<KMime::Message>();
-    m_contextMsg->from()->fromUnicodeString(ui->senderBox->currentText());
-    m_contextMsg->date()->setDateTime(ui->contextDate->dateTime());
-    m_engine.setContext(QVariant::fromValue<KMime::Content*>(m_contextMsg.get()), u"message/rfc822");
-
-    m_engine.setData(m_data, ui->fileRequester->url().path());
-    const auto data = m_engine.extract();
-    ui->extractorWidget->showExtractor(m_engine.usedCustomExtractor());
-
-    m_extractorDocModel->setRootNode(m_engine.rootDocumentNode());
-    ui->documentTreeView->expandAll();
-    setCurrentDocumentNode(m_engine.rootDocumentNode());
-
-    m_outputDoc->setReadWrite(true);
-    m_outputDoc->setText(QString::fromUtf8(QJsonDocument(data).toJson()));
-    m_outputDoc->setReadWrite(false);
-
-    ExtractorPostprocessor postproc;
-    postproc.setContextDate(ui->contextDate->dateTime());
-    postproc.process(JsonLdDocument::fromJson(data));
-    auto result = postproc.result();
-
-    m_postprocDoc->setReadWrite(true);
-    m_postprocDoc->setText(QString::fromUtf8(QJsonDocument(JsonLdDocument::toJson(result)).toJson()));
-    m_postprocDoc->setReadWrite(false);
-
-    ExtractorValidator validator;
-    validator.setAcceptOnlyCompleteElements(ui->acceptCompleteOnly->isChecked());
-    result.erase(std::remove_if(result.begin(), result.end(), [&validator](const auto &elem) {
-        return !validator.isValidElement(elem);
-    }), result.end());
-    m_validatedDoc->setReadWrite(true);
-    m_validatedDoc->setText(QString::fromUtf8(QJsonDocument(JsonLdDocument::toJson(result)).toJson()));
-    m_validatedDoc->setReadWrite(false);
-
-    const auto batches = batchReservations(result);
-    KCalendarCore::Calendar::Ptr cal(new KCalendarCore::MemoryCalendar(QTimeZone::systemTimeZone()));
-    for (const auto &batch : batches) {
-        KCalendarCore::Event::Ptr event(new KCalendarCore::Event);
-        CalendarHandler::fillEvent(batch, event);
-        cal->addEvent(event);
-    }
-    KCalendarCore::ICalFormat format;
-    m_icalDoc->setText(format.toString(cal));
+    // the on-disk cache tier only got the stages computed by the time the run got inserted
+    if (m_currentRun->outputStages.revision() != revision) {
+        m_runner->post([cache = m_runner->cache(), run = m_currentRun]() { cache->update(run); });
+    }
+
+    if (!profile.stages.empty()) {
+        m_profileModel->addStages(profile);
+    }
 }
 
 void MainWindow::urlChanged()
@@ -390,104 +651,280 @@ void MainWindow::urlChanged()
         return;
     }
 
+    if (url.isLocalFile()) {
+        // map local files directly rather than copying them into memory via KIO
+        ExtractorInput input;
+        QString errorString;
+        if (!ExtractorPipeline::loadFile(input, url.toLocalFile(), &errorString)) {
+            qWarning() << errorString;
+            return;
+        }
+        inputLoaded(url, input.data, input.mappedFile);
+        return;
+    }
+
     auto job = KIO::storedGet(url);
     connect(job, &KJob::finished, this, [this, job, url]() {
         if (job->error() != KJob::NoError) {
             qWarning() << job->errorString();
             return;
         }
-        m_data = job->data();
-        const auto isText = std::none_of(m_data.begin(), m_data.end(), [](unsigned char c) { return std::iscntrl(c) && !std::isspace(c); });
-        const auto textExt =
-            url.fileName().endsWith(QLatin1String(".eml")) ||
-            url.fileName().endsWith(QLatin1String(".html")) ||
-            url.fileName().endsWith(QLatin1String(".mbox")) ||
-            url.fileName().endsWith(QLatin1String(".txt"));
-        if (isText || textExt) {
-            if (url.scheme() == QLatin1String("https") || url.scheme() == QLatin1String("http")) {
-                m_sourceDoc->setText(QString::fromUtf8(m_data));
-            } else {
-                m_sourceDoc->openUrl(url);
-            }
-            m_sourceView->show();
+        inputLoaded(url, job->data(), {});
+    });
+}
+
+void MainWindow::inputLoaded(const QUrl &url, const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile)
+{
+    if (url.fileName().endsWith(QLatin1String(".mbox")) || MailboxModel::isMailbox(data)) {
+        // only individual messages go through the extractor, everything else would be way too slow
+        m_data.clear();
+        m_mappedFile.reset();
+        m_sourceView->hide();
+        setHexViewData({}, {});
+        m_mailboxModel->setMailbox(data, mappedFile);
+        ui->mailboxWidget->show();
+        ui->mailboxView->setCurrentIndex(m_mailboxModel->index(0, 0));
+        return;
+    }
+    clearMailbox();
+
+    const auto textExt =
+        url.fileName().endsWith(QLatin1String(".eml")) ||
+        url.fileName().endsWith(QLatin1String(".html")) ||
+        url.fileName().endsWith(QLatin1String(".txt"));
+    if (textExt || ExtractorPipeline::isText(data)) {
+        // the input data is taken from the source document in this case, no need to hold on to it
+        m_data.clear();
+        m_mappedFile.reset();
+        if (url.scheme() == QLatin1String("https") || url.scheme() == QLatin1String("http")) {
+            m_sourceDoc->setText(QString::fromUtf8(data));
         } else {
-            m_sourceView->hide();
-            sourceChanged();
+            m_sourceDoc->openUrl(url);
         }
-    });
+        m_sourceView->show();
+        setHexViewData({}, {});
+    } else {
+        m_data = data;
+        m_mappedFile = mappedFile;
+        m_sourceView->hide();
+        setHexViewData(m_data, m_mappedFile);
+        sourceChanged();
+    }
 }
 
 void MainWindow::loadFromClipboard()
 {
     ui->fileRequester->clear();
+    clearMailbox();
 
     const auto md = QGuiApplication::clipboard()->mimeData();
     if (md->hasText()) {
         m_sourceDoc->setText(md->text());
         m_sourceView->show();
+        setHexViewData({}, {});
     } else if (md->hasFormat(QLatin1String("application/octet-stream"))) {
         m_data = md->data(QLatin1String("application/octet-stream"));
+        m_mappedFile.reset();
         m_sourceView->hide();
+        setHexViewData(m_data, {});
     }
     sourceChanged();
 }
 
+void MainWindow::setHexViewData(const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile)
+{
+    // binary input can't be edited, but still should be inspectable
+    m_hexView->setData(data, mappedFile);
+    m_hexView->setVisible(!data.isEmpty());
+}
+
+void MainWindow::clearMailbox()
+{
+    m_mailboxModel->clear();
+    ui->mailboxWidget->hide();
+}
+
 void MainWindow::imageContextMenu(QPoint pos)
 {
     using namespace KItinerary;
 
     const auto idx = ui->imageView->currentIndex();
-    if (!idx.isValid())
-        return;
 
     QMenu menu;
     const auto barcode = menu.addAction(i18n("Decode && Copy Barcode"));
     const auto barcodeBinary = menu.addAction(i18n("Decode && Copy Barcode (Binary)"));
+    const auto scanAll = menu.addAction(i18n("Decode All Barcodes"));
     menu.addSeparator();
     const auto save = menu.addAction(i18n("Save Image..."));
     const auto bcSave = menu.addAction(i18n("Save Barcode Content..."));
-    if (auto action = menu.exec(ui->imageView->viewport()->mapToGlobal(pos))) {
-        if (action == barcode) {
-            BarcodeDecoder decoder;
-            const auto code = decoder.decode(idx.data(Qt::DecorationRole).value<QImage>(), BarcodeDecoder::Any | BarcodeDecoder::IgnoreAspectRatio).toString();
-            QGuiApplication::clipboard()->setText(code);
-        } else if (action == barcodeBinary) {
-            BarcodeDecoder decoder;
-            const auto b = decoder.decode(idx.data(Qt::DecorationRole).value<QImage>(), BarcodeDecoder::Any | BarcodeDecoder::IgnoreAspectRatio).toByteArray();
+    for (auto action : { barcode, barcodeBinary, save, bcSave }) {
+        action->setEnabled(idx.isValid());
+    }
+    const auto action = menu.exec(ui->imageView->viewport()->mapToGlobal(pos));
+    if (!action) {
+        return;
+    }
+
+    // full resolution images and barcodes are only decoded on demand, and barcodes only once
+    if (action == scanAll) {
+        m_imageModel->scanBarcodes();
+    } else if (action == barcode) {
+        m_imageModel->requestBarcode(idx, [](const QVariant &code) {
+            QGuiApplication::clipboard()->setText(code.toString());
+        });
+    } else if (action == barcodeBinary) {
+        m_imageModel->requestBarcode(idx, [](const QVariant &code) {
             auto md = new QMimeData;
-            md->setData(QStringLiteral("application/octet-stream"), b);
+            md->setData(QStringLiteral("application/octet-stream"), code.toByteArray());
             QGuiApplication::clipboard()->setMimeData(md);
-        } else if (action == save) {
-            const auto fileName = QFileDialog::getSaveFileName(this, i18n("Save Image"));
-            idx.data(Qt::DecorationRole).value<QImage>().save(fileName);
-        } else if (action == bcSave) {
-            const auto fileName = QFileDialog::getSaveFileName(this, i18n("Save Barcode Content"));
-            if (!fileName.isEmpty()) {
-                BarcodeDecoder decoder;
-                const auto b = decoder.decode(idx.data(Qt::DecorationRole).value<QImage>(), BarcodeDecoder::Any | BarcodeDecoder::IgnoreAspectRatio).toByteArray();
-                QFile f(fileName);
-                if (!f.open(QFile::WriteOnly)) {
-                    qWarning() << "Failed to open file:" << f.errorString() << fileName;
-                } else {
-                    f.write(b);
-                }
-            }
+        });
+    } else if (action == save) {
+        const auto fileName = QFileDialog::getSaveFileName(this, i18n("Save Image"));
+        if (fileName.isEmpty()) {
+            return;
         }
+        m_imageModel->requestImage(idx, [fileName](const QImage &img) {
+            img.save(fileName);
+        });
+    } else if (action == bcSave) {
+        const auto fileName = QFileDialog::getSaveFileName(this, i18n("Save Barcode Content"));
+        if (fileName.isEmpty()) {
+            return;
+        }
+        m_imageModel->requestBarcode(idx, [fileName](const QVariant &code) {
+            QFile f(fileName);
+            if (!f.open(QFile::WriteOnly)) {
+                qWarning() << "Failed to open file:" << f.errorString() << fileName;
+            } else {
+                f.write(code.toByteArray());
+            }
+        });
     }
 }
 
+void MainWindow::evaluateXPath()
+{
+    ++m_xpathGeneration;
+    m_xpathMatch = -1;
+    m_domModel->setHighlightNodeSet({});
+    ui->domView->viewport()->update(); // dirty, but easier than triggering a proper full model update
+    ui->xpathPrevButton->setEnabled(false);
+    ui->xpathNextButton->setEnabled(false);
+
+    const auto doc = m_domModel->document();
+    const auto query = ui->xpathEdit->text();
+    if (!doc || query.isEmpty()) {
+        ui->xpathResultLabel->clear();
+        return;
+    }
+
+    ui->xpathResultLabel->setText(i18n("Evaluating…"));
+    // queries can take a while on large documents, so keep those off the UI thread, on the thread owning the
+    // document tree, as neither concurrent queries nor re-running extractors on the same document are safe
+    // the run owns the document, holding on to it keeps the document alive until we are done
+    m_runner->post([this, doc, query, run = m_currentRun, generation = m_xpathGeneration]() {
+        QElapsedTimer timer;
+        timer.start();
+        const auto res = doc->eval(query);
+        const auto elapsed = timer.nsecsElapsed();
+        QMetaObject::invokeMethod(this, [this, doc, res, elapsed, generation]() {
+            if (generation != m_xpathGeneration || doc != m_domModel->document()) {
+                return;
+            }
+            xpathEvaluated(res, elapsed);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::xpathEvaluated(const QVariant &result, qint64 elapsed)
+{
+    const auto ms = QLocale().toString(elapsed / 1'000'000.0, 'f', 1);
+    if (!result.canConvert<QVariantList>()) {
+        ui->xpathResultLabel->setText(i18n("Result: %1 (%2 ms)", result.toString(), ms));
+        return;
+    }
+
+    m_domModel->setHighlightNodeSet(result.value<QVariantList>());
+    ui->domView->viewport()->update();
+    const auto count = m_domModel->highlightCount();
+    ui->xpathResultLabel->setText(i18np("1 match (%2 ms)", "%1 matches (%2 ms)", count, ms));
+    ui->xpathPrevButton->setEnabled(count > 0);
+    ui->xpathNextButton->setEnabled(count > 0);
+    if (count > 0) {
+        selectXPathMatch(0);
+    }
+}
+
+void MainWindow::selectXPathMatch(int match)
+{
+    const auto count = m_domModel->highlightCount();
+    if (count == 0) {
+        return;
+    }
+    m_xpathMatch = (match + count) % count;
+
+    // matches hidden by the search filter are not reachable in the view
+    const auto filterModel = qobject_cast<QSortFilterProxyModel*>(ui->domView->model());
+    const auto idx = filterModel->mapFromSource(m_domModel->highlightIndex(m_xpathMatch));
+    if (!idx.isValid()) {
+        return;
+    }
+    ui->domView->setCurrentIndex(idx);
+    ui->domView->scrollTo(idx);
+}
+
+void MainWindow::evaluateXPathCorpus()
+{
+    const auto query = ui->xpathEdit->text();
+    if (query.isEmpty() || m_xpathCorpus) {
+        return;
+    }
+    const auto dir = QFileDialog::getExistingDirectory(this, i18n("Sample Directory"), m_xpathCorpusDir);
+    if (dir.isEmpty()) {
+        return;
+    }
+    m_xpathCorpusDir = dir;
+
+    auto evaluator = std::make_shared<XPathCorpusEvaluator>();
+    evaluator->setQuery(query);
+    evaluator->setJobCount(QThread::idealThreadCount());
+    evaluator->addPath(dir);
+    m_xpathCorpus = evaluator;
+    ui->xpathCorpusButton->setEnabled(false);
+    statusBar()->showMessage(i18n("Evaluating XPath query on samples in %1...", dir));
+
+    m_xpathCorpusPool.start([this, evaluator, query]() {
+        const auto samples = evaluator->exec();
+        QMetaObject::invokeMethod(this, [this, query, samples]() {
+            m_xpathCorpus.reset();
+            ui->xpathCorpusButton->setEnabled(true);
+            statusBar()->clearMessage();
+            if (samples.empty()) {
+                statusBar()->showMessage(i18n("No samples found."));
+                return;
+            }
+
+            auto dlg = new XPathCorpusDialog(this);
+            dlg->setAttribute(Qt::WA_DeleteOnClose);
+            dlg->setResult(query, samples);
+            connect(dlg, &XPathCorpusDialog::sampleActivated, this, &MainWindow::openFile);
+            dlg->show();
+        }, Qt::QueuedConnection);
+    });
+}
+
 void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode &node)
 {
     for (auto i : { TextTab, ImageTab, DomTab, Uic9183Tab, IataBcbpTab, EraSsbTab, VdvTab }) {
         ui->inputTabWidget->setTabEnabled(i, false);
     }
 
-    StandardItemModelHelper::clearContent(m_imageModel);
+    m_imageModel->clear();
     m_domModel->setDocument(nullptr);
 
     using namespace KItinerary;
     m_currentNode = node;
-    m_nodeResultDoc->setText(QString::fromUtf8(QJsonDocument(node.result().jsonLdResult()).toJson()));
+    m_nodeResultUpdater->setText(QString::fromUtf8(QJsonDocument(node.result().jsonLdResult()).toJson()));
 
     if (node.mimeType() == QLatin1String("application/pdf")) {
         const auto pdf = node.content<PdfDocument*>();
@@ -496,35 +933,14 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
         }
         m_preprocDoc->setText(pdf->text());
 
-        for (int i = 0; i < pdf->pageCount(); ++i) {
-            auto pageItem = new QStandardItem;
-            pageItem->setText(i18n("Page %1", i + 1));
-            const auto page = pdf->page(i);
-            for (int j = 0; j < page.imageCount(); ++j) {
-                auto imgItem = new QStandardItem;
-                auto pdfImg = page.image(j);
-                auto imgData = pdfImg.image();
-                bool skippedByExtractor = false;
-                if (imgData.isNull()) {
-                    skippedByExtractor = true;
-                    pdfImg.setLoadingHints(PdfImage::NoHint);
-                    imgData = pdfImg.image();
-                }
-                imgItem->setData(imgData, Qt::DecorationRole);
-                imgItem->setToolTip(i18n("Size: %1 x %2\nSource: %3 x %4\nSkipped: %5", pdfImg.width(), pdfImg.height(), pdfImg.sourceWidth(), pdfImg.sourceHeight(), skippedByExtractor));
-                pageItem->appendRow(imgItem);
-            }
-            m_imageModel->appendRow(pageItem);
-        }
+        m_imageModel->setPdf(pdf, m_currentRun);
         ui->imageView->expandAll();
 
         ui->inputTabWidget->setTabEnabled(TextTab, true);
         ui->inputTabWidget->setTabEnabled(ImageTab, true);
     }
     else if (node.mimeType() == QLatin1String("internal/qimage")) {
-        auto item = new QStandardItem;
-        item->setData(node.content<QImage>(), Qt::DecorationRole);
-        m_imageModel->appendRow(item);
+        m_imageModel->setImage(node.content<QImage>());
         ui->inputTabWidget->setTabEnabled(ImageTab, true);
     }
     else if (node.mimeType() == QLatin1String("internal/uic9183")) {
@@ -536,7 +952,8 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
         const auto html = node.content<HtmlDocument*>();
         m_domModel->setDocument(html);
         m_preprocDoc->setText(html->root().recursiveContent());
-        ui->domView->expandAll();
+        expandDomTree();
+        evaluateXPath();
         ui->inputTabWidget->setTabEnabled(TextTab, true);
         ui->inputTabWidget->setTabEnabled(DomTab, true);
     }
@@ -576,7 +993,7 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
             StandardItemModelHelper::fillFromGadget(sec, secItem);
         }
 
-        ui->iataBcbpView->expandAll();
+        expandTree(ui->iataBcbpView);
         ui->inputTabWidget->setTabEnabled(IataBcbpTab, true);
     }
     else if (node.mimeType() == QLatin1String("internal/era-ssb")) {
@@ -619,7 +1036,7 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
             StandardItemModelHelper::fillFromGadget(node.content(), m_eraSsbModel->invisibleRootItem());
         }
 
-        ui->eraSsbView->expandAll();
+        expandTree(ui->eraSsbView);
         ui->inputTabWidget->setTabEnabled(EraSsbTab, true);
     }
     else if (node.mimeType() == QLatin1String("internal/era-elb")) {
@@ -647,18 +1064,21 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
             StandardItemModelHelper::addEntry(i18n("Departure date"), elb.segment2().departureDate(node.contextDateTime()).toString(Qt::ISODate), parent);
         }
 
-        ui->eraSsbView->expandAll();
+        expandTree(ui->eraSsbView);
         ui->inputTabWidget->setTabEnabled(EraSsbTab, true);
     }
     else if (node.mimeType() == QLatin1String("internal/vdv")) {
         StandardItemModelHelper::clearContent(m_vdvModel);
         const auto vdv = node.content<VdvTicket>();
+        const auto rawData = vdv.rawData();
+        ui->vdvHexView->setData(rawData);
         auto item = StandardItemModelHelper::addEntry(i18n("Header"), {}, m_vdvModel->invisibleRootItem());
         StandardItemModelHelper::fillFromGadget(vdv.header(), item);
 
         item = StandardItemModelHelper::addEntry(i18n("Product data"), {}, m_vdvModel->invisibleRootItem());
         for (auto block = vdv.productData().first(); block.isValid(); block = block.next()) {
             auto blockItem = StandardItemModelHelper::addEntry(i18n("Block 0x%1 (%2 bytes)", QString::number(block.type(), 16), block.size()), {}, item);
+            StandardItemModelHelper::setDataRange(blockItem, block.contentData(), block.contentSize(), rawData);
             switch (block.type()) {
                 case VdvTicketBasicData::Tag:
                     StandardItemModelHelper::fillFromGadget(block.contentAt<VdvTicketBasicData>(), blockItem);
@@ -679,18 +1099,18 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
                     {
                         const auto area31 = static_cast<const VdvTicketValidityAreaDataType31*>(area);
                         StandardItemModelHelper::fillFromGadget(area31, blockItem);
-                        StandardItemModelHelper::addEntry(i18n("Payload"), StandardItemModelHelper::dataToHex(block.contentData(), block.contentSize(), sizeof(VdvTicketValidityAreaDataType31)), blockItem);
+                        StandardItemModelHelper::addDataEntry(i18n("Payload"), block.contentData() + sizeof(VdvTicketValidityAreaDataType31), block.contentSize() - (qsizetype)sizeof(VdvTicketValidityAreaDataType31), blockItem, rawData);
                         break;
                     }
                     default:
                         StandardItemModelHelper::fillFromGadget(area, blockItem);
-                        StandardItemModelHelper::addEntry(i18n("Payload"), StandardItemModelHelper::dataToHex(block.contentData(), block.contentSize(), sizeof(VdvTicketValidityAreaData)), blockItem);
+                        StandardItemModelHelper::addDataEntry(i18n("Payload"), block.contentData() + sizeof(VdvTicketValidityAreaData), block.contentSize() - (qsizetype)sizeof(VdvTicketValidityAreaData), blockItem, rawData);
                         break;
                 }
                 break;
             }
             default:
-                StandardItemModelHelper::addEntry(i18n("Data"), StandardItemModelHelper::dataToHex(block.contentData(), block.contentSize()), blockItem);
+                StandardItemModelHelper::addDataEntry(i18n("Data"), block.contentData(), block.contentSize(), blockItem, rawData);
             }
         }
 
@@ -699,9 +1119,10 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
         item = StandardItemModelHelper::addEntry(i18n("Product-specific transaction data (%1 bytes)", vdv.productSpecificTransactionData().contentSize()), {}, m_vdvModel->invisibleRootItem());
         for (auto block = vdv.productSpecificTransactionData().first(); block.isValid(); block = block.next()) {
             auto blockItem = StandardItemModelHelper::addEntry(i18n("Tag 0x%1 (%2 bytes)", QString::number(block.type(), 16), block.size()), {}, item);
+            StandardItemModelHelper::setDataRange(blockItem, block.contentData(), block.contentSize(), rawData);
             switch (block.type()) {
                 default:
-                    StandardItemModelHelper::addEntry(i18n("Data"), StandardItemModelHelper::dataToHex(block.contentData(), block.contentSize()), blockItem);
+                    StandardItemModelHelper::addDataEntry(i18n("Data"), block.contentData(), block.contentSize(), blockItem, rawData);
             }
         }
 
@@ -711,13 +1132,13 @@ void MainWindow::setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode
         StandardItemModelHelper::addEntry(i18n("identifier"), QString::fromUtf8(vdv.trailer()->identifier, 3), item);
         StandardItemModelHelper::fillFromGadget(vdv.trailer(), item);
 
-        ui->vdvView->expandAll();
+        expandTree(ui->vdvView);
         ui->inputTabWidget->setTabEnabled(VdvTab, true);
     } else if (node.mimeType() == QLatin1String("internal/uic-dosipas")) {
         StandardItemModelHelper::clearContent(m_eraSsbModel);
         const auto dosipasContainer = node.content();
         StandardItemModelHelper::fillFromGadget(QMetaType(dosipasContainer.typeId()).metaObject(), dosipasContainer.data(), m_eraSsbModel->invisibleRootItem());
-        ui->eraSsbView->expandAll();
+        expandTree(ui->eraSsbView);
         ui->inputTabWidget->setTabEnabled(EraSsbTab, true);
     }
 }
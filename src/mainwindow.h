@@ -7,16 +7,18 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "extractorindex.h"
+#include "extractorrunner.h"
+#include "outputstages.h"
+
 #include <KItinerary/ExtractorDocumentNode>
 #include <KItinerary/ExtractorEngine>
 
 #include <KXmlGuiWindow>
 
-#include <memory>
+#include <QThreadPool>
 
-namespace KMime {
-class Message;
-}
+#include <memory>
 
 namespace KTextEditor {
 class Document;
@@ -31,7 +33,16 @@ class MainWindow;
 class AttributeModel;
 class DocumentModel;
 class DOMModel;
+class HexView;
+class ImageModel;
+class MailboxModel;
+class ProfileModel;
+class QFile;
 class QStandardItemModel;
+class QTimer;
+class QTreeView;
+class TextDocumentUpdater;
+class XPathCorpusEvaluator;
 
 class MainWindow : public KXmlGuiWindow
 {
@@ -62,14 +73,33 @@ private:
         PostprocessorTab = 2,
         ValidatedTab = 3,
         ICalTab = 4,
-        ConsoleTab = 5
+        ConsoleTab = 5,
+        ProfileTab = 6,
     };
 
+    void loadSettings();
+    void expandTree(QTreeView *view);
+    void expandDomTree();
     void clearEngine();
     void sourceChanged();
+    void extractorChanged();
+    void extractorsModified(const std::vector<ExtractorMetaData> &extractors, const std::vector<ExtractorMetaData> &previousExtractors, bool metaDataChanged);
+    void runExtractor();
+    void startExtraction(ExtractorRunner::CachePolicy cachePolicy);
+    void applyRun(const std::shared_ptr<ExtractorRun> &run, StageProfile profile);
+    void invalidateOutputTabs(OutputStages::Stage stage);
+    void updateOutputTab();
     void urlChanged();
+    void inputLoaded(const QUrl &url, const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile);
     void loadFromClipboard();
+    void setHexViewData(const QByteArray &data, const std::shared_ptr<const QFile> &mappedFile);
+    void clearMailbox();
+    void prefetchMailbox(const ExtractorInput &input);
     void imageContextMenu(QPoint pos);
+    void evaluateXPath();
+    void xpathEvaluated(const QVariant &result, qint64 elapsed);
+    void selectXPathMatch(int match);
+    void evaluateXPathCorpus();
     void setCurrentDocumentNode(const KItinerary::ExtractorDocumentNode &node);
 
 private:
@@ -83,19 +113,38 @@ private:
     KTextEditor::Document *m_validatedDoc = nullptr;
     KTextEditor::Document *m_icalDoc = nullptr;
     KTextEditor::View *m_sourceView = nullptr;
+    HexView *m_hexView = nullptr;
+    TextDocumentUpdater *m_nodeResultUpdater = nullptr;
+    TextDocumentUpdater *m_outputUpdater = nullptr;
+    TextDocumentUpdater *m_postprocUpdater = nullptr;
+    TextDocumentUpdater *m_validatedUpdater = nullptr;
 
     DocumentModel *m_extractorDocModel;
-    QStandardItemModel *m_imageModel;
+    ImageModel *m_imageModel;
     DOMModel *m_domModel;
     AttributeModel *m_attrModel;
     QStandardItemModel *m_iataBcbpModel;
     QStandardItemModel *m_eraSsbModel;
     QStandardItemModel *m_vdvModel;
-
-    KItinerary::ExtractorEngine m_engine;
+    ProfileModel *m_profileModel;
+    MailboxModel *m_mailboxModel;
+
+    ExtractorRunner *m_runner = nullptr;
+    QTimer *m_extractTimer = nullptr;
+    std::shared_ptr<ExtractorRun> m_currentRun;
+    OutputStages m_outputStages;
+    int m_staleOutputTabs = 0; // bitmask of OutputTab values
+    KItinerary::ExtractorEngine::Hints m_engineHints = KItinerary::ExtractorEngine::ExtractGenericIcalEvents | KItinerary::ExtractorEngine::ExtractFullPageRasterImages;
     QByteArray m_data;
-    std::unique_ptr<KMime::Message> m_contextMsg;
+    std::shared_ptr<const QFile> m_mappedFile;
     KItinerary::ExtractorDocumentNode m_currentNode;
+    int m_autoExpandDepth = 0;
+    int m_xpathGeneration = 0;
+    int m_xpathMatch = -1;
+    std::shared_ptr<XPathCorpusEvaluator> m_xpathCorpus;
+    QString m_xpathCorpusDir;
+    // last, so pending queries finish before anything they use is destroyed
+    QThreadPool m_xpathCorpusPool;
 };
 
 #endif // MAINWINDOW_H
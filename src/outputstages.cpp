@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "outputstages.h"
+#include "extractorpipeline.h"
+
+void OutputStages::setRun(const std::shared_ptr<const ExtractorRun> &run)
+{
+    m_run = run;
+    invalidateFrom(Extractor);
+    if (m_run) {
+        m_validStages |= 1 << Extractor;
+    }
+}
+
+void OutputStages::setAcceptCompleteOnly(bool acceptCompleteOnly)
+{
+    if (m_acceptCompleteOnly == acceptCompleteOnly) {
+        return;
+    }
+    m_acceptCompleteOnly = acceptCompleteOnly;
+    invalidateFrom(Validated);
+}
+
+bool OutputStages::isValid(Stage stage) const
+{
+    return m_validStages & (1 << stage);
+}
+
+const QVector<QVariant>& OutputStages::postprocessed(StageProfile *profile)
+{
+    if (!isValid(Postprocessed) && m_run) {
+        if (auto cached = m_run->outputStages.postprocessed()) {
+            m_postprocessed = std::move(*cached);
+        } else {
+            m_postprocessed = ExtractorPipeline::postprocess(m_run->extractorOutput, m_run->input.contextDate, profile);
+            m_run->outputStages.setPostprocessed(m_postprocessed);
+        }
+        m_validStages |= 1 << Postprocessed;
+    }
+    return m_postprocessed;
+}
+
+const QVector<QVariant>& OutputStages::validated(StageProfile *profile)
+{
+    if (!isValid(Validated) && m_run) {
+        if (auto cached = m_run->outputStages.validated(m_acceptCompleteOnly)) {
+            m_validated = std::move(*cached);
+        } else {
+            m_validated = ExtractorPipeline::validate(postprocessed(profile), m_acceptCompleteOnly, profile);
+            m_run->outputStages.setValidated(m_acceptCompleteOnly, m_validated);
+        }
+        m_validStages |= 1 << Validated;
+    }
+    return m_validated;
+}
+
+const QString& OutputStages::iCal(StageProfile *profile)
+{
+    if (!isValid(ICal) && m_run) {
+        if (auto cached = m_run->outputStages.iCal(m_acceptCompleteOnly)) {
+            m_iCal = std::move(*cached);
+        } else {
+            m_iCal = ExtractorPipeline::toICal(validated(profile), profile);
+            m_run->outputStages.setICal(m_acceptCompleteOnly, m_iCal);
+        }
+        m_validStages |= 1 << ICal;
+    }
+    return m_iCal;
+}
+
+void OutputStages::invalidateFrom(Stage stage)
+{
+    m_validStages &= (1 << stage) - 1;
+    if (stage <= Postprocessed) {
+        m_postprocessed.clear();
+    }
+    if (stage <= Validated) {
+        m_validated.clear();
+    }
+    if (stage <= ICal) {
+        m_iCal.clear();
+    }
+}
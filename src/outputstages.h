@@ -0,0 +1,57 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef OUTPUTSTAGES_H
+#define OUTPUTSTAGES_H
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include <memory>
+
+class ExtractorRun;
+class StageProfile;
+
+/** Lazily evaluated pipeline stages downstream of the extractor.
+ *  Each stage is only computed when requested, and is invalidated along with
+ *  everything depending on it when one of its inputs changes.
+ *  Computed stages are stored in the run as well, so they are reused for cached runs.
+ */
+class OutputStages
+{
+public:
+    enum Stage {
+        Extractor,
+        Postprocessed,
+        Validated,
+        ICal,
+    };
+
+    /** Sets the extractor stage result, invalidating all subsequent stages. */
+    void setRun(const std::shared_ptr<const ExtractorRun> &run);
+    /** Changes the validation mode, invalidating the validation and iCal stages. */
+    void setAcceptCompleteOnly(bool acceptCompleteOnly);
+
+    bool isValid(Stage stage) const;
+
+    const QVector<QVariant>& postprocessed(StageProfile *profile = nullptr);
+    const QVector<QVariant>& validated(StageProfile *profile = nullptr);
+    const QString& iCal(StageProfile *profile = nullptr);
+
+private:
+    void invalidateFrom(Stage stage);
+
+    std::shared_ptr<const ExtractorRun> m_run;
+    bool m_acceptCompleteOnly = true;
+    int m_validStages = 0;
+
+    QVector<QVariant> m_postprocessed;
+    QVector<QVariant> m_validated;
+    QString m_iCal;
+};
+
+#endif // OUTPUTSTAGES_H
@@ -0,0 +1,142 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "profilemodel.h"
+#include "allocationtracker.h"
+
+#include <KLocalizedString>
+
+#include <QLocale>
+
+#include <algorithm>
+
+enum {
+    MaxHistorySize = 50,
+};
+
+enum {
+    StageColumn,
+    WallTimeColumn,
+    DeltaColumn,
+    AllocationsColumn,
+    AllocatedBytesColumn,
+    ColumnCount
+};
+
+static QString formatTime(qint64 nsecs)
+{
+    return i18n("%1 ms", QLocale().toString(nsecs / 1.0e6, 'f', 2));
+}
+
+static QString formatDelta(qint64 nsecs, qint64 previousNsecs)
+{
+    if (previousNsecs <= 0) {
+        return {};
+    }
+    const auto delta = nsecs - previousNsecs;
+    return i18n("%1%2 ms (%3%4%)", delta >= 0 ? QStringLiteral("+") : QString(), QLocale().toString(delta / 1.0e6, 'f', 2),
+                delta >= 0 ? QStringLiteral("+") : QString(), QLocale().toString(100.0 * delta / previousNsecs, 'f', 0));
+}
+
+static QList<QStandardItem*> makeRow(const QString &name, qint64 wallTime, qint64 previousWallTime, qint64 allocations, qint64 allocatedBytes)
+{
+    QList<QStandardItem*> row;
+    row.reserve(ColumnCount);
+    row.push_back(new QStandardItem(name));
+    row.push_back(new QStandardItem(formatTime(wallTime)));
+    row.push_back(new QStandardItem(formatDelta(wallTime, previousWallTime)));
+    row.push_back(new QStandardItem(allocations < 0 ? QString() : QLocale().toString(allocations)));
+    row.push_back(new QStandardItem(allocatedBytes < 0 ? QString() : QLocale().formattedDataSize(allocatedBytes)));
+    for (auto it = row.begin() + 1; it != row.end(); ++it) {
+        (*it)->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    // highlight significant regressions
+    if (previousWallTime > 0 && wallTime > previousWallTime * 3 / 2 && wallTime - previousWallTime > 1000000) {
+        row[DeltaColumn]->setForeground(Qt::red);
+    }
+    return row;
+}
+
+ProfileModel::ProfileModel(QObject *parent)
+    : QStandardItemModel(parent)
+{
+    // without malloc coverage most of what Qt containers allocate is missing
+    if (AllocationTracker::coversMalloc()) {
+        setHorizontalHeaderLabels({i18n("Stage"), i18n("Wall Time"), i18n("Δ Previous Run"), i18n("Allocations"), i18n("Allocated")});
+    } else {
+        setHorizontalHeaderLabels({i18n("Stage"), i18n("Wall Time"), i18n("Δ Previous Run"), i18n("Allocations (operator new only)"), i18n("Allocated (operator new only)")});
+    }
+}
+
+ProfileModel::~ProfileModel() = default;
+
+static const StageProfile::Stage* findStage(const StageProfile &profile, const QString &name)
+{
+    const auto it = std::find_if(profile.stages.begin(), profile.stages.end(), [&name](const auto &s) { return s.name == name; });
+    return it == profile.stages.end() ? nullptr : &(*it);
+}
+
+void ProfileModel::addRun(const QString &label, const StageProfile &profile)
+{
+    m_previousProfile = std::move(m_currentProfile);
+    m_currentProfile = {};
+
+    insertRow(0, makeRow(i18n("#%1: %2", ++m_runCount, label), 0, 0, -1, -1));
+    addStages(profile);
+
+    if (rowCount() > MaxHistorySize) {
+        removeRows(MaxHistorySize, rowCount() - MaxHistorySize);
+    }
+}
+
+void ProfileModel::addStages(const StageProfile &profile)
+{
+    auto runItem = item(0, StageColumn);
+    if (!runItem) {
+        return;
+    }
+
+    for (const auto &stage : profile.stages) {
+        const auto prev = findStage(m_previousProfile, stage.name);
+        runItem->appendRow(makeRow(stage.name, stage.wallTime, prev ? prev->wallTime : 0, stage.allocations, stage.allocatedBytes));
+        m_currentProfile.stages.push_back(stage);
+    }
+    updateRunRow();
+}
+
+void ProfileModel::updateRunRow()
+{
+    qint64 allocations = -1;
+    qint64 allocatedBytes = -1;
+    for (const auto &stage : m_currentProfile.stages) {
+        if (stage.allocations >= 0) {
+            allocations = std::max<qint64>(allocations, 0) + stage.allocations;
+            allocatedBytes = std::max<qint64>(allocatedBytes, 0) + stage.allocatedBytes;
+        }
+    }
+
+    // compare only the stages both runs have, lazily computed ones might not be present in both
+    qint64 previousWallTime = 0;
+    qint64 comparableWallTime = 0;
+    for (const auto &stage : m_currentProfile.stages) {
+        if (const auto prev = findStage(m_previousProfile, stage.name)) {
+            previousWallTime += prev->wallTime;
+            comparableWallTime += stage.wallTime;
+        }
+    }
+
+    const auto row = makeRow(QString(), m_currentProfile.wallTime(), 0, allocations, allocatedBytes);
+    const auto delta = makeRow(QString(), comparableWallTime, previousWallTime, -1, -1);
+    for (int col = WallTimeColumn; col < ColumnCount; ++col) {
+        const auto src = col == DeltaColumn ? delta[col] : row[col];
+        auto dst = item(0, col);
+        dst->setText(src->text());
+        dst->setData(src->data(Qt::ForegroundRole), Qt::ForegroundRole);
+    }
+    qDeleteAll(row);
+    qDeleteAll(delta);
+}
@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef PROFILEMODEL_H
+#define PROFILEMODEL_H
+
+#include "stageprofile.h"
+
+#include <QStandardItemModel>
+
+/** Rolling history of per-stage extraction profiles, most recent run first. */
+class ProfileModel : public QStandardItemModel
+{
+    Q_OBJECT
+public:
+    explicit ProfileModel(QObject *parent = nullptr);
+    ~ProfileModel();
+
+    /** Adds a profile of a run labeled @p label, dropping the oldest one if the history is full. */
+    void addRun(const QString &label, const StageProfile &profile);
+    /** Adds stages computed on demand after the fact to the most recent run. */
+    void addStages(const StageProfile &profile);
+
+private:
+    void updateRunRow();
+
+    StageProfile m_currentProfile;
+    StageProfile m_previousProfile;
+    int m_runCount = 0;
+};
+
+#endif // PROFILEMODEL_H
@@ -0,0 +1,385 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "resultcache.h"
+#include "extractorindex.h"
+#include "extractorpipeline.h"
+#include "logcapture.h"
+
+#include <KItinerary/ExtractorFilter>
+#include <KItinerary/ExtractorRepository>
+#include <KItinerary/JsonLdDocument>
+#include <KItinerary/ScriptExtractor>
+
+#include <KMime/Message>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace KItinerary;
+
+// bump this when changing the key or the on-disk format
+constexpr inline const char CacheFormatVersion[] = "4";
+
+namespace {
+struct FileHash {
+    qint64 lastModified = 0;
+    qint64 size = -1;
+    QByteArray hash;
+};
+}
+
+/** Content hash of @p fileName, only re-computed if the file changed. */
+static QByteArray fileContentHash(const QString &fileName)
+{
+    static std::mutex mutex;
+    static QHash<QString, FileHash> cache;
+
+    const QFileInfo fi(fileName);
+    const auto lastModified = fi.lastModified().toMSecsSinceEpoch();
+    const auto size = fi.size();
+
+    std::lock_guard lock(mutex);
+    auto &entry = cache[fileName];
+    if (entry.hash.isEmpty() || entry.lastModified != lastModified || entry.size != size) {
+        QFile f(fileName);
+        if (!f.open(QFile::ReadOnly)) {
+            return {};
+        }
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(&f);
+        entry = { lastModified, size, hash.result() };
+    }
+    return entry.hash;
+}
+
+ResultCache::ResultCache() = default;
+ResultCache::~ResultCache() = default;
+
+QByteArray ResultCache::extractorFingerprint()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    ExtractorRepository repo;
+    for (const auto &ext : repo.extractors()) {
+        hash.addData(ext->name().toUtf8());
+        const auto script = dynamic_cast<const ScriptExtractor*>(ext.get());
+        if (!script) {
+            continue;
+        }
+        hash.addData(script->mimeType().toUtf8());
+        hash.addData(script->scriptFunction().toUtf8());
+        for (const auto &filter : script->filters()) {
+            hash.addData(filter.mimeType().toUtf8());
+            hash.addData(filter.fieldName().toUtf8());
+            hash.addData(filter.pattern().toUtf8());
+            hash.addData(QByteArray::number(filter.scope()));
+        }
+        hash.addData(script->scriptFileName().toUtf8());
+        hash.addData(fileContentHash(script->scriptFileName()));
+    }
+    return hash.result();
+}
+
+QByteArray ResultCache::key(const ExtractorInput &input, const QByteArray &extractorFingerprint)
+{
+    return key(QCryptographicHash::hash(input.data, QCryptographicHash::Sha256), input, extractorFingerprint);
+}
+
+QByteArray ResultCache::key(const ExtractorInput &input, bool memorizeDataHash)
+{
+    std::unique_lock lock(m_keyMutex);
+    auto fingerprint = m_extractorFingerprint;
+    const auto fileStates = m_extractorFileStates;
+    const auto generation = m_extractorFingerprintGeneration;
+    lock.unlock();
+
+    // files can change outside of the editor before anyone gets to call invalidateExtractorFingerprint()
+    if (fingerprint.isEmpty() || !isUnchanged(fileStates)) {
+        // before hashing, so changes while we are at it show up next time
+        auto newFileStates = extractorFileStates();
+        fingerprint = extractorFingerprint();
+        lock.lock();
+        // don't memorize anything that got invalidated while we were computing it
+        if (generation == m_extractorFingerprintGeneration) {
+            m_extractorFingerprint = fingerprint;
+            m_extractorFileStates = std::move(newFileStates);
+        }
+        lock.unlock();
+    }
+    return key(dataHash(input, memorizeDataHash), input, fingerprint);
+}
+
+std::vector<std::pair<QString, ResultCache::FileState>> ResultCache::extractorFileStates()
+{
+    ExtractorRepository repo;
+    QStringList fileNames = ExtractorIndex::searchPaths(repo.additionalSearchPaths());
+    for (const auto &ext : repo.extractors()) {
+        if (const auto script = dynamic_cast<const ScriptExtractor*>(ext.get())) {
+            fileNames.push_back(script->fileName());
+            fileNames.push_back(script->scriptFileName());
+        }
+    }
+    fileNames.removeDuplicates();
+
+    std::vector<std::pair<QString, FileState>> fileStates;
+    for (const auto &fileName : std::as_const(fileNames)) {
+        if (fileName.startsWith(QLatin1Char(':'))) {
+            continue;
+        }
+        const QFileInfo fi(fileName);
+        fileStates.emplace_back(fileName, FileState{ fi.lastModified().toMSecsSinceEpoch(), fi.size() });
+    }
+    return fileStates;
+}
+
+bool ResultCache::isUnchanged(const std::vector<std::pair<QString, FileState>> &fileStates)
+{
+    return std::all_of(fileStates.begin(), fileStates.end(), [](const auto &fileState) {
+        const QFileInfo fi(fileState.first);
+        return fi.lastModified().toMSecsSinceEpoch() == fileState.second.lastModified && fi.size() == fileState.second.size;
+    });
+}
+
+void ResultCache::invalidateExtractorFingerprint()
+{
+    std::lock_guard lock(m_keyMutex);
+    m_extractorFingerprint.clear();
+    ++m_extractorFingerprintGeneration;
+}
+
+QByteArray ResultCache::dataHash(const ExtractorInput &input, bool memorize)
+{
+    // a file mapping follows changes to the file, so for that sharing only means identical content if the file is unchanged
+    FileState mappedFileState;
+    if (input.mappedFile) {
+        const QFileInfo fi(input.mappedFile->fileName());
+        mappedFileState = { fi.lastModified().toMSecsSinceEpoch(), fi.size() };
+    }
+    {
+        std::lock_guard lock(m_keyMutex);
+        // we keep the buffer (or the file mapping) of m_lastData alive, so sharing it means identical content
+        if (!m_lastDataHash.isEmpty() && input.data.isSharedWith(m_lastData) && input.data.size() == m_lastData.size()
+            && mappedFileState.lastModified == m_lastMappedFileState.lastModified && mappedFileState.size == m_lastMappedFileState.size) {
+            return m_lastDataHash;
+        }
+    }
+
+    const auto hash = QCryptographicHash::hash(input.data, QCryptographicHash::Sha256);
+    if (!memorize) {
+        return hash;
+    }
+    std::lock_guard lock(m_keyMutex);
+    m_lastData = input.data;
+    m_lastMappedFile = input.mappedFile;
+    m_lastMappedFileState = mappedFileState;
+    m_lastDataHash = hash;
+    return hash;
+}
+
+QByteArray ResultCache::key(const QByteArray &dataHash, const ExtractorInput &input, const QByteArray &extractorFingerprint)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(CacheFormatVersion);
+    hash.addData(dataHash);
+    hash.addData(input.fileName.toUtf8());
+    hash.addData(input.sender.toUtf8());
+    hash.addData(input.contextDate.toString(Qt::ISODateWithMs).toUtf8());
+    hash.addData(QByteArray::number(static_cast<int>(input.hints)));
+    hash.addData(input.separateProcess ? "1" : "0");
+    hash.addData(extractorFingerprint);
+    return hash.result();
+}
+
+void ResultCache::setCapacity(std::size_t capacity)
+{
+    std::lock_guard lock(m_mutex);
+    m_capacity = capacity;
+    while (m_entries.size() > m_capacity) {
+        m_entries.erase(m_entries.begin());
+    }
+}
+
+void ResultCache::setDiskCachePath(const QString &path)
+{
+    std::lock_guard lock(m_mutex);
+    m_diskCachePath = path;
+    if (!path.isEmpty()) {
+        QDir().mkpath(path);
+    }
+}
+
+QString ResultCache::diskCachePath() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_diskCachePath;
+}
+
+QString ResultCache::defaultDiskCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/results");
+}
+
+std::shared_ptr<ExtractorRun> ResultCache::lookup(const QByteArray &key)
+{
+    std::unique_lock lock(m_mutex);
+    const auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const auto &entry) { return entry.first == key; });
+    if (it != m_entries.end()) {
+        auto entry = std::move(*it);
+        m_entries.erase(it);
+        m_entries.push_back(std::move(entry));
+        return m_entries.back().second;
+    }
+    lock.unlock();
+
+    auto run = loadFromDisk(key);
+    if (run) {
+        lock.lock();
+        m_entries.emplace_back(key, run);
+        while (m_entries.size() > m_capacity) {
+            m_entries.erase(m_entries.begin());
+        }
+    }
+    return run;
+}
+
+void ResultCache::insert(const QByteArray &key, const std::shared_ptr<ExtractorRun> &run)
+{
+    std::unique_lock lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&key](const auto &entry) { return entry.first == key; }), m_entries.end());
+    if (m_capacity > 0) {
+        m_entries.emplace_back(key, run);
+    }
+    while (m_entries.size() > m_capacity) {
+        m_entries.erase(m_entries.begin());
+    }
+    lock.unlock();
+
+    storeOnDisk(key, run.get());
+}
+
+void ResultCache::update(const std::shared_ptr<ExtractorRun> &run)
+{
+    std::unique_lock lock(m_mutex);
+    const auto it = std::find_if(m_entries.begin(), m_entries.end(), [&run](const auto &entry) { return entry.second == run; });
+    if (it == m_entries.end()) {
+        return;
+    }
+    const auto key = it->first;
+    lock.unlock();
+
+    storeOnDisk(key, run.get());
+}
+
+void ResultCache::remove(const std::shared_ptr<ExtractorRun> &run)
+{
+    std::lock_guard lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&run](const auto &entry) { return entry.second == run; }), m_entries.end());
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+    if (!m_diskCachePath.isEmpty()) {
+        QDir dir(m_diskCachePath);
+        for (const auto &file : dir.entryList({QStringLiteral("*.json")}, QDir::Files)) {
+            dir.remove(file);
+        }
+    }
+}
+
+QString ResultCache::diskCacheFileName(const QByteArray &key) const
+{
+    std::lock_guard lock(m_mutex);
+    if (m_diskCachePath.isEmpty()) {
+        return {};
+    }
+    return m_diskCachePath + QLatin1Char('/') + QString::fromLatin1(key.toHex()) + QLatin1String(".json");
+}
+
+std::shared_ptr<ExtractorRun> ResultCache::loadFromDisk(const QByteArray &key) const
+{
+    const auto fileName = diskCacheFileName(key);
+    if (fileName.isEmpty()) {
+        return {};
+    }
+    QFile f(fileName);
+    if (!f.open(QFile::ReadOnly)) {
+        return {};
+    }
+
+    const auto obj = QJsonDocument::fromJson(f.readAll()).object();
+    if (obj.isEmpty()) {
+        return {};
+    }
+    auto run = std::make_shared<ExtractorRun>();
+    // script output of the original run isn't kept by the console, don't show that of unrelated messages instead
+    run->id = LogScope::createRunId();
+    run->extractorOutput = obj.value(QLatin1String("extractorOutput")).toArray();
+    run->usedExtractor = obj.value(QLatin1String("usedExtractor")).toString();
+    run->consoleOutput = obj.value(QLatin1String("console")).toArray();
+    if (const auto val = obj.value(QLatin1String("postprocessed")); val.isArray()) {
+        run->outputStages.setPostprocessed(JsonLdDocument::fromJson(val.toArray()));
+    }
+    for (const auto acceptCompleteOnly : { true, false }) {
+        const auto stages = obj.value(QLatin1String(acceptCompleteOnly ? "completeOnly" : "acceptIncomplete")).toObject();
+        if (const auto val = stages.value(QLatin1String("validated")); val.isArray()) {
+            run->outputStages.setValidated(acceptCompleteOnly, JsonLdDocument::fromJson(val.toArray()));
+        }
+        if (const auto val = stages.value(QLatin1String("iCal")); val.isString()) {
+            run->outputStages.setICal(acceptCompleteOnly, val.toString());
+        }
+    }
+    return run;
+}
+
+void ResultCache::storeOnDisk(const QByteArray &key, const ExtractorRun *run) const
+{
+    const auto fileName = diskCacheFileName(key);
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QJsonObject obj;
+    obj.insert(QLatin1String("extractorOutput"), run->extractorOutput);
+    obj.insert(QLatin1String("usedExtractor"), run->usedExtractor);
+    if (!run->consoleOutput.isEmpty()) {
+        obj.insert(QLatin1String("console"), run->consoleOutput);
+    }
+    if (const auto postprocessed = run->outputStages.postprocessed()) {
+        obj.insert(QLatin1String("postprocessed"), JsonLdDocument::toJson(*postprocessed));
+    }
+    for (const auto acceptCompleteOnly : { true, false }) {
+        QJsonObject stages;
+        if (const auto validated = run->outputStages.validated(acceptCompleteOnly)) {
+            stages.insert(QLatin1String("validated"), JsonLdDocument::toJson(*validated));
+        }
+        if (const auto iCal = run->outputStages.iCal(acceptCompleteOnly)) {
+            stages.insert(QLatin1String("iCal"), *iCal);
+        }
+        if (!stages.isEmpty()) {
+            obj.insert(QLatin1String(acceptCompleteOnly ? "completeOnly" : "acceptIncomplete"), stages);
+        }
+    }
+
+    QSaveFile f(fileName);
+    if (!f.open(QFile::WriteOnly)) {
+        qWarning() << "Failed to write result cache entry:" << f.errorString() << fileName;
+        return;
+    }
+    f.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    f.commit();
+}
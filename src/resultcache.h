@@ -0,0 +1,103 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class ExtractorInput;
+class ExtractorRun;
+class QFile;
+
+/** Cache for extraction pipeline results, keyed by a hash of everything that influences them.
+ *  That is the input data, the extraction settings and the content of all extractor scripts.
+ *
+ *  The in-memory tier keeps entire runs including their document tree, the optional on-disk
+ *  tier only has the pipeline outputs, including the downstream stages computed by the time
+ *  a run is inserted or updated.
+ *
+ *  All methods are thread-safe.
+ */
+class ResultCache
+{
+public:
+    ResultCache();
+    ~ResultCache();
+
+    /** Hash over meta data and script content of all extractors in the repository. */
+    static QByteArray extractorFingerprint();
+    /** Computes the cache key for @p input. */
+    static QByteArray key(const ExtractorInput &input, const QByteArray &extractorFingerprint);
+    /** Computes the cache key for @p input, based on the extractor fingerprint memorized by this cache.
+     *  Computing that visits every extractor of the repository, so it is only re-computed after
+     *  invalidateExtractorFingerprint() has been called, or when any extractor file or search path
+     *  changed its modification time or size.
+     *  The hash of the input data is memorized as well if @p memorizeDataHash is set, only worth it
+     *  for inputs that are looked up repeatedly.
+     */
+    QByteArray key(const ExtractorInput &input, bool memorizeDataHash = true);
+    /** Call when any extractor or the repository changed. */
+    void invalidateExtractorFingerprint();
+
+    /** Maximum number of runs kept in memory. */
+    void setCapacity(std::size_t capacity);
+    /** Enables the on-disk tier in @p path, or disables it if @p path is empty. */
+    void setDiskCachePath(const QString &path);
+    QString diskCachePath() const;
+    /** Default location for the on-disk tier. */
+    static QString defaultDiskCachePath();
+
+    std::shared_ptr<ExtractorRun> lookup(const QByteArray &key);
+    void insert(const QByteArray &key, const std::shared_ptr<ExtractorRun> &run);
+    /** Writes the on-disk entry of @p run again, e.g. after more downstream stages got computed.
+     *  Does nothing if @p run isn't in the in-memory tier anymore.
+     */
+    void update(const std::shared_ptr<ExtractorRun> &run);
+    /** Removes @p run from the in-memory tier. */
+    void remove(const std::shared_ptr<ExtractorRun> &run);
+    /** Clears the in-memory and the on-disk tier. */
+    void clear();
+
+private:
+    class FileState {
+    public:
+        qint64 lastModified = 0;
+        qint64 size = -1;
+    };
+
+    std::shared_ptr<ExtractorRun> loadFromDisk(const QByteArray &key) const;
+    void storeOnDisk(const QByteArray &key, const ExtractorRun *run) const;
+    QString diskCacheFileName(const QByteArray &key) const;
+    static QByteArray key(const QByteArray &dataHash, const ExtractorInput &input, const QByteArray &extractorFingerprint);
+    QByteArray dataHash(const ExtractorInput &input, bool memorize);
+    /** All extractor files and search paths that can change, ie. that are not compiled in. */
+    static std::vector<std::pair<QString, FileState>> extractorFileStates();
+    static bool isUnchanged(const std::vector<std::pair<QString, FileState>> &fileStates);
+
+    mutable std::mutex m_mutex;
+    std::vector<std::pair<QByteArray, std::shared_ptr<ExtractorRun>>> m_entries; // most recently used last
+    std::size_t m_capacity = 8;
+    QString m_diskCachePath;
+
+    mutable std::mutex m_keyMutex;
+    QByteArray m_extractorFingerprint;
+    quint64 m_extractorFingerprintGeneration = 0;
+    std::vector<std::pair<QString, FileState>> m_extractorFileStates; // by the time the fingerprint got computed
+    // the same input is usually looked up repeatedly, with only the extractors changing in between
+    QByteArray m_lastData;
+    std::shared_ptr<const QFile> m_lastMappedFile;
+    FileState m_lastMappedFileState;
+    QByteArray m_lastDataHash;
+};
+
+#endif // RESULTCACHE_H
@@ -26,6 +26,10 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     ExtractorRepository repo;
     m_searchPathModel->setStringList(repo.additionalSearchPaths());
 
+    QSettings settings;
+    settings.beginGroup(QStringLiteral("DocumentTree"));
+    ui->autoExpandDepth->setValue(settings.value(QStringLiteral("AutoExpandDepth"), DefaultAutoExpandDepth).toInt());
+
     connect(ui->searchPathAddButton, &QPushButton::clicked, this, [this]() {
         if (!ui->searchPathRequester->url().isValid()) {
             return;
@@ -55,6 +59,10 @@ void SettingsDialog::accept()
     QSettings settings;
     settings.beginGroup(QStringLiteral("Extractor Repository"));
     settings.setValue(QStringLiteral("SearchPaths"), repo.additionalSearchPaths());
+    settings.endGroup();
+
+    settings.beginGroup(QStringLiteral("DocumentTree"));
+    settings.setValue(QStringLiteral("AutoExpandDepth"), ui->autoExpandDepth->value());
 
     QDialog::accept();
 }
@@ -29,6 +29,9 @@ public:
 
     void accept() override;
 
+    /** Depth to which the document and DOM trees are expanded, -1 for everything. */
+    static constexpr inline int DefaultAutoExpandDepth = 3;
+
 private:
     std::unique_ptr<Ui::SettingsDialog> ui;
     QStringListModel *m_searchPathModel = nullptr;
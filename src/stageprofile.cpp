@@ -0,0 +1,42 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "stageprofile.h"
+
+#include <numeric>
+
+qint64 StageProfile::wallTime() const
+{
+    return std::accumulate(stages.begin(), stages.end(), qint64(0), [](qint64 t, const auto &stage) { return t + stage.wallTime; });
+}
+
+StageProfile::Measurement::Measurement(StageProfile *profile, const QString &name)
+    : m_profile(profile)
+{
+    if (!m_profile) {
+        return;
+    }
+    m_name = name;
+    m_counters = AllocationTracker::threadCounters();
+    m_timer.start();
+}
+
+StageProfile::Measurement::~Measurement()
+{
+    if (!m_profile) {
+        return;
+    }
+
+    Stage stage;
+    stage.name = m_name;
+    stage.wallTime = m_timer.nsecsElapsed();
+    if (AllocationTracker::isEnabled()) {
+        const auto counters = AllocationTracker::threadCounters();
+        stage.allocations = counters.count - m_counters.count;
+        stage.allocatedBytes = counters.bytes - m_counters.bytes;
+    }
+    m_profile->stages.push_back(std::move(stage));
+}
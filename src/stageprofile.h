@@ -0,0 +1,52 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef STAGEPROFILE_H
+#define STAGEPROFILE_H
+
+#include "allocationtracker.h"
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <vector>
+
+/** Wall time and allocation statistics of the stages of one extraction run. */
+class StageProfile
+{
+public:
+    class Stage
+    {
+    public:
+        QString name;
+        qint64 wallTime = 0; // nsecs
+        qint64 allocations = -1;
+        qint64 allocatedBytes = -1;
+    };
+    std::vector<Stage> stages;
+
+    /** Total wall time of all stages, in nsecs. */
+    qint64 wallTime() const;
+
+    /** Records the lifetime of this object as stage @p name in @p profile.
+     *  Allocations are counted for the current thread only.
+     *  Does nothing if @p profile is @c nullptr.
+     */
+    class Measurement
+    {
+    public:
+        explicit Measurement(StageProfile *profile, const QString &name);
+        ~Measurement();
+
+    private:
+        StageProfile *m_profile;
+        QString m_name;
+        QElapsedTimer m_timer;
+        AllocationTracker::Counters m_counters;
+    };
+};
+
+#endif // STAGEPROFILE_H
@@ -5,12 +5,18 @@
 */
 
 #include "standarditemmodelhelper.h"
+#include "gadgetitemmodel.h"
+#include "hexview.h"
 
+#include <QHash>
 #include <QMetaProperty>
 #include <QSequentialIterable>
 #include <QStandardItem>
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <vector>
 
 using namespace Qt::Literals;
 
@@ -35,9 +41,14 @@ void StandardItemModelHelper::fillFromGadget(const QVariant &value, QStandardIte
     fillFromGadget(QMetaType(value.userType()).metaObject(), value.constData(), parent);
 }
 
+static bool isListType(QMetaType mt)
+{
+    return QMetaType::canConvert(mt, QMetaType::fromType<QVariantList>()) && mt.id() != QMetaType::QString && mt.id() != QMetaType::QByteArray;
+}
+
 static bool isListType(const QVariant &value)
 {
-    return value.canConvert<QVariantList>() && value.typeId() != QMetaType::QString && value.typeId() != QMetaType::QByteArray;
+    return isListType(value.metaType());
 }
 
 static void setEnabledRecursive(QStandardItem *item, bool enabled)
@@ -58,53 +69,57 @@ static void setEnabledRecursive(QStandardItem *item, bool enabled)
     }
 }
 
-void StandardItemModelHelper::fillFromGadget(const QMetaObject *mo, const void *gadget, QStandardItem *parent)
+namespace {
+/** How to show one gadget property, derived from the meta object only. */
+struct PropertyPlan {
+    enum Kind {
+        Dynamic, // QVariant property, everything below depends on the actual value
+        List,
+        Enum,
+        ByteArray,
+        Convertible,
+        TypeName,
+    };
+
+    QMetaProperty prop;
+    QString name;
+    Kind kind = Dynamic;
+    bool hasChildren = false; // gadget or list
+    int isSetProperty = -1; // index of the corresponding "...IsSet" property of ASN.1 optional values
+};
+
+using GadgetPlan = std::vector<PropertyPlan>;
+}
+
+static GadgetPlan createPlan(const QMetaObject *mo)
 {
-    if (!gadget || !mo) {
-        return;
-    }
+    GadgetPlan plan;
     for (auto i = 0; i < mo->propertyCount(); ++i) {
         const auto prop = mo->property(i);
         if (!prop.isStored()) {
             continue;
         }
-        const auto value = prop.readOnGadget(gadget);
-        QString valueString;
-        if (isListType(value)) {
-            valueString = QString::fromUtf8(value.typeName());
-        } else if (prop.isEnumType()) {
-            valueString = QString::fromUtf8(prop.enumerator().valueToKey(value.toInt()));
-        } else if (prop.typeId() == QMetaType::QByteArray) {
-            const auto b = value.toByteArray();
-            if (std::ranges::any_of(b, [](unsigned char c) { return std::iscntrl(c); })) {
-                valueString = "(hex) "_L1 + QString::fromLatin1(value.toByteArray().toHex());
-            } else {
-                valueString = QString::fromUtf8(b);
-            }
-        } else if (!QMetaType::canConvert(QMetaType(value.typeId()), QMetaType(QMetaType::QString))) {
-            valueString = QString::fromUtf8(value.typeName());
+
+        PropertyPlan p;
+        p.prop = prop;
+        p.name = QString::fromUtf8(prop.name());
+        const auto mt = prop.metaType();
+        if (mt.id() == QMetaType::QVariant) {
+            p.kind = PropertyPlan::Dynamic;
+        } else if (isListType(mt)) {
+            p.kind = PropertyPlan::List;
+            p.hasChildren = true;
         } else {
-            valueString = value.toString();
-        }
-        auto item = addEntry(QString::fromUtf8(prop.name()), valueString, parent);
-
-        if (const auto childMo = QMetaType(value.typeId()).metaObject()) {
-            fillFromGadget(childMo, value.constData(), item);
-        } else if (isListType(value)) {
-            auto iterable = value.value<QSequentialIterable>();
-            int idx = 0;
-            for (const QVariant &v : iterable) {
-                QString valueString;
-                if (!QMetaType::canConvert(QMetaType(v.typeId()), QMetaType(QMetaType::QString))) {
-                    valueString = QString::fromUtf8(v.typeName());
-                } else {
-                    valueString = v.toString();
-                }
-                auto arrayItem = addEntry(QString::number(idx++), valueString, item);
-                if (const auto childMo = QMetaType(v.typeId()).metaObject()) {
-                    fillFromGadget(childMo, v.constData(), arrayItem);
-                }
+            if (prop.isEnumType()) {
+                p.kind = PropertyPlan::Enum;
+            } else if (mt.id() == QMetaType::QByteArray) {
+                p.kind = PropertyPlan::ByteArray;
+            } else if (QMetaType::canConvert(mt, QMetaType::fromType<QString>())) {
+                p.kind = PropertyPlan::Convertible;
+            } else {
+                p.kind = PropertyPlan::TypeName;
             }
+            p.hasChildren = mt.metaObject();
         }
 
         // ASN.1 optional properties
@@ -114,16 +129,142 @@ void StandardItemModelHelper::fillFromGadget(const QMetaObject *mo, const void *
             if (optProp.typeId() == QMetaType::Bool && std::strlen(optProp.name()) - 5 == nameLen
                 && std::strncmp(prop.name(), optProp.name(), nameLen) == 0 && std::strcmp(optProp.name() + nameLen, "IsSet") == 0)
             {
-                if (!optProp.readOnGadget(gadget).toBool()) {
-                    setEnabledRecursive(item, false);
-                }
+                p.isSetProperty = i + 1;
                 ++i;
             }
         }
+        plan.push_back(std::move(p));
+    }
+    return plan;
+}
+
+// meta objects are static data, so this never needs invalidation
+// only used from the UI thread
+static const GadgetPlan& gadgetPlan(const QMetaObject *mo)
+{
+    static QHash<const QMetaObject*, GadgetPlan> s_plans;
+    auto it = s_plans.find(mo);
+    if (it == s_plans.end()) {
+        it = s_plans.insert(mo, createPlan(mo));
+    }
+    return it.value();
+}
+
+static QString valueToString(const QVariant &value)
+{
+    if (!QMetaType::canConvert(value.metaType(), QMetaType::fromType<QString>())) {
+        return QString::fromUtf8(value.typeName());
     }
+    return value.toString();
 }
 
-QString StandardItemModelHelper::dataToHex(const uint8_t *data, int size, int offset)
+static QString byteArrayToString(const QByteArray &b)
 {
-    return QString::fromUtf8(QByteArray((const char*)data + offset, size - offset).toHex());
+    if (std::ranges::any_of(b, [](unsigned char c) { return std::iscntrl(c); })) {
+        return "(hex) "_L1 + QString::fromLatin1(b.toHex());
+    }
+    return QString::fromUtf8(b);
+}
+
+static bool hasChildValues(const QVariant &value)
+{
+    return value.metaType().metaObject() || isListType(value);
+}
+
+void StandardItemModelHelper::fillFromGadget(const QMetaObject *mo, const void *gadget, QStandardItem *parent)
+{
+    if (!gadget || !mo) {
+        return;
+    }
+
+    const auto lazy = qobject_cast<GadgetItemModel*>(parent->model());
+    for (const auto &p : gadgetPlan(mo)) {
+        const auto value = p.prop.readOnGadget(gadget);
+        QString valueString;
+        auto kind = p.kind;
+        if (kind == PropertyPlan::Dynamic) {
+            kind = isListType(value) ? PropertyPlan::List : value.typeId() == QMetaType::QByteArray ? PropertyPlan::ByteArray : PropertyPlan::Convertible;
+        }
+        switch (kind) {
+            case PropertyPlan::List:
+            case PropertyPlan::TypeName:
+                valueString = QString::fromUtf8(value.typeName());
+                break;
+            case PropertyPlan::Enum:
+                valueString = QString::fromUtf8(p.prop.enumerator().valueToKey(value.toInt()));
+                break;
+            case PropertyPlan::ByteArray:
+                valueString = byteArrayToString(value.toByteArray());
+                break;
+            case PropertyPlan::Convertible:
+            case PropertyPlan::Dynamic:
+                valueString = valueToString(value);
+                break;
+        }
+        auto item = addEntry(p.name, valueString, parent);
+
+        if (p.hasChildren || (p.kind == PropertyPlan::Dynamic && hasChildValues(value))) {
+            if (lazy) {
+                item->setData(value, GadgetItemModel::PendingValueRole);
+            } else {
+                fillFromValue(value, item);
+            }
+        }
+
+        if (p.isSetProperty >= 0 && !mo->property(p.isSetProperty).readOnGadget(gadget).toBool()) {
+            setEnabledRecursive(item, false);
+        }
+    }
+}
+
+void StandardItemModelHelper::fillFromValue(const QVariant &value, QStandardItem *item)
+{
+    if (const auto childMo = value.metaType().metaObject()) {
+        fillFromGadget(childMo, value.constData(), item);
+    } else if (isListType(value)) {
+        const auto lazy = qobject_cast<GadgetItemModel*>(item->model());
+        auto iterable = value.value<QSequentialIterable>();
+        int idx = 0;
+        for (const QVariant &v : iterable) {
+            auto arrayItem = addEntry(QString::number(idx++), valueToString(v), item);
+            if (v.metaType().metaObject()) {
+                if (lazy) {
+                    arrayItem->setData(v, GadgetItemModel::PendingValueRole);
+                } else {
+                    fillFromValue(v, arrayItem);
+                }
+            }
+        }
+    }
+
+    // children of unset optional values added on demand
+    if (!item->isEnabled()) {
+        for (auto i = 0; i < item->rowCount(); ++i) {
+            setEnabledRecursive(item->child(i, 0), false);
+        }
+    }
+}
+
+QStandardItem* StandardItemModelHelper::addDataEntry(const QString &key, const uint8_t *data, qsizetype size, QStandardItem *parent, const QByteArray &base)
+{
+    // a full hex dump of large blocks belongs into a HexView, not into a tree cell
+    constexpr qsizetype PreviewSize = 32;
+    size = std::max<qsizetype>(0, size);
+    auto preview = QString::fromLatin1(QByteArray::fromRawData(reinterpret_cast<const char*>(data), std::min(size, PreviewSize)).toHex());
+    if (size > PreviewSize) {
+        preview += QStringLiteral("... (%1 bytes)").arg(size);
+    }
+    auto item = addEntry(key, preview, parent);
+    setDataRange(item, data, size, base);
+    return item;
+}
+
+void StandardItemModelHelper::setDataRange(QStandardItem *item, const uint8_t *data, qsizetype size, const QByteArray &base)
+{
+    const auto begin = reinterpret_cast<const uint8_t*>(base.constData());
+    if (!data || data < begin || size < 0 || data + size > begin + base.size()) {
+        return;
+    }
+    item->setData(qint64(data - begin), HexView::OffsetRole);
+    item->setData(qint64(size), HexView::SizeRole);
 }
@@ -7,8 +7,11 @@
 #ifndef STANDARDITEMMODELHELPER_H
 #define STANDARDITEMMODELHELPER_H
 
+#include <QtGlobal>
+
 #include <cstdint>
 
+class QByteArray;
 class QMetaObject;
 class QStandardItem;
 class QStandardItemModel;
@@ -23,6 +26,10 @@ void clearContent(QStandardItemModel *model);
 
 QStandardItem* addEntry(const QString &key, const QString &value, QStandardItem *parent);
 
+/** Adds one row per stored property of a gadget to @p parent.
+ *  Child gadgets and lists are read on demand when @p parent belongs to a GadgetItemModel,
+ *  and recursively right away otherwise.
+ */
 void fillFromGadget(const QVariant &value, QStandardItem *parent);
 void fillFromGadget(const QMetaObject *mo, const void *gadget, QStandardItem *parent);
 template <typename T>
@@ -36,7 +43,17 @@ inline void fillFromGadget(const T *value, QStandardItem *parent)
     return fillFromGadget(&T::staticMetaObject, value, parent);
 }
 
-QString dataToHex(const uint8_t *data, int size, int offset = 0);
+/** Adds the content of a gadget or list @p value as children of @p item. */
+void fillFromValue(const QVariant &value, QStandardItem *item);
+
+/** Adds an entry for @p size bytes of binary @p data, showing a bounded hex preview of it.
+ *  If @p data is located within @p base the entry also gets a data range, see setDataRange().
+ */
+QStandardItem* addDataEntry(const QString &key, const uint8_t *data, qsizetype size, QStandardItem *parent, const QByteArray &base);
+/** Marks @p item as corresponding to @p data, if that is located within @p base.
+ *  The position is stored in the HexView offset and size roles.
+ */
+void setDataRange(QStandardItem *item, const uint8_t *data, qsizetype size, const QByteArray &base);
 
 }
 
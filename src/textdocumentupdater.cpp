@@ -0,0 +1,204 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "textdocumentupdater.h"
+
+#include <KTextEditor/Attribute>
+#include <KTextEditor/Document>
+#include <KTextEditor/MovingRange>
+
+#include <KColorScheme>
+
+#include <algorithm>
+
+// line comparisons after which we give up on a minimal diff, unrelated documents would otherwise take up to (N+M)*D of those
+constexpr inline qint64 MaxComparisons = 4'000'000;
+
+std::vector<TextDiff::Hunk> TextDiff::diff(const QStringList &oldLines, const QStringList &newLines, int maxEditDistance)
+{
+    // common prefix and suffix, that's usually most of it
+    int begin = 0;
+    while (begin < oldLines.size() && begin < newLines.size() && oldLines.at(begin) == newLines.at(begin)) {
+        ++begin;
+    }
+    int oldEnd = oldLines.size();
+    int newEnd = newLines.size();
+    while (oldEnd > begin && newEnd > begin && oldLines.at(oldEnd - 1) == newLines.at(newEnd - 1)) {
+        --oldEnd;
+        --newEnd;
+    }
+
+    std::vector<Hunk> hunks;
+    const int n = oldEnd - begin;
+    const int m = newEnd - begin;
+    if (n == 0 && m == 0) {
+        return hunks;
+    }
+    if (n == 0 || m == 0) {
+        hunks.push_back({begin, n, begin, m});
+        return hunks;
+    }
+
+    // Myers' O(ND) algorithm on the remainder, keeping the furthest reaching x per diagonal k for every d
+    const auto a = [&](int x) -> const QString& { return oldLines.at(begin + x); };
+    const auto b = [&](int y) -> const QString& { return newLines.at(begin + y); };
+    const int maxD = std::min(n + m, maxEditDistance);
+    std::vector<int> v(2 * maxD + 3, 0);
+    const int offset = maxD + 1;
+    // the trace takes O(D²) memory, which is what maxEditDistance bounds
+    std::vector<std::vector<int>> trace;
+    qint64 comparisons = 0;
+    bool done = false;
+    int d = 0;
+    for (; d <= maxD && comparisons <= MaxComparisons; ++d) {
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            int y = x - k;
+            const int snakeBegin = x;
+            while (x < n && y < m && a(x) == b(y)) {
+                ++x;
+                ++y;
+            }
+            comparisons += x - snakeBegin + 1;
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                done = true;
+            }
+        }
+        trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+        if (done) {
+            break;
+        }
+    }
+    if (!done) {
+        hunks.push_back({begin, n, begin, m});
+        return hunks;
+    }
+
+    // walk back through the trace, collecting the edit script in reverse order
+    enum Op { Delete, Insert };
+    std::vector<std::pair<Op, int>> ops; // deleted old index resp. inserted new index
+    int x = n;
+    int y = m;
+    for (; d > 0; --d) {
+        const auto &prev = trace[d - 1];
+        const auto at = [&prev, d](int k) { return prev[k + d - 1]; };
+        const int k = x - y;
+        const int prevK = (k == -d || (k != d && at(k - 1) < at(k + 1))) ? k + 1 : k - 1;
+        const int prevX = at(prevK);
+        const int prevY = prevX - prevK;
+        while (x > prevX && y > prevY) {
+            --x;
+            --y;
+        }
+        if (x == prevX) {
+            ops.emplace_back(Insert, prevY);
+        } else {
+            ops.emplace_back(Delete, prevX);
+        }
+        x = prevX;
+        y = prevY;
+    }
+
+    // merge adjacent edits into hunks
+    std::reverse(ops.begin(), ops.end());
+    int oldPos = 0;
+    int newPos = 0;
+    for (const auto &[op, idx] : ops) {
+        // advance over the unchanged lines in between
+        const int skip = op == Delete ? idx - oldPos : idx - newPos;
+        oldPos += skip;
+        newPos += skip;
+        const bool extend = !hunks.empty() && hunks.back().oldBegin + hunks.back().oldCount == begin + oldPos
+                                           && hunks.back().newBegin + hunks.back().newCount == begin + newPos;
+        if (!extend) {
+            hunks.push_back({begin + oldPos, 0, begin + newPos, 0});
+        }
+        if (op == Delete) {
+            ++hunks.back().oldCount;
+            ++oldPos;
+        } else {
+            ++hunks.back().newCount;
+            ++newPos;
+        }
+    }
+    return hunks;
+}
+
+TextDocumentUpdater::TextDocumentUpdater(KTextEditor::Document *doc)
+    : QObject(doc)
+    , m_doc(doc)
+{
+    // moving ranges must not outlive the document internals
+    connect(doc, &KTextEditor::Document::aboutToDeleteMovingInterfaceContent, this, &TextDocumentUpdater::clearChangeMarkers);
+    connect(doc, &KTextEditor::Document::aboutToInvalidateMovingInterfaceContent, this, &TextDocumentUpdater::clearChangeMarkers);
+}
+
+TextDocumentUpdater::~TextDocumentUpdater() = default;
+
+void TextDocumentUpdater::setText(const QString &text)
+{
+    auto lines = text.split(QLatin1Char('\n'));
+    clearChangeMarkers();
+    m_lastChanges.clear();
+
+    const auto readWrite = m_doc->isReadWrite();
+    m_doc->setReadWrite(true);
+
+    if (m_lines.isEmpty() || m_doc->lines() != m_lines.size()) {
+        // initial content, or someone changed the document behind our back
+        m_doc->setText(text);
+    } else {
+        m_lastChanges = TextDiff::diff(m_lines, lines);
+        m_doc->editStart();
+        // back to front, so line numbers of the remaining hunks stay valid
+        for (auto it = m_lastChanges.rbegin(); it != m_lastChanges.rend(); ++it) {
+            const auto &hunk = *it;
+            if (hunk.oldCount == 0) {
+                m_doc->insertLines(hunk.oldBegin, lines.mid(hunk.newBegin, hunk.newCount));
+            } else if (hunk.newCount == 0) {
+                for (int i = 0; i < hunk.oldCount; ++i) {
+                    m_doc->removeLine(hunk.oldBegin);
+                }
+            } else {
+                const auto lastLine = hunk.oldBegin + hunk.oldCount - 1;
+                const KTextEditor::Range range(hunk.oldBegin, 0, lastLine, m_lines.at(lastLine).size());
+                m_doc->replaceText(range, lines.mid(hunk.newBegin, hunk.newCount).join(QLatin1Char('\n')));
+            }
+        }
+        m_doc->editEnd();
+    }
+
+    m_doc->setReadWrite(readWrite);
+    m_lines = std::move(lines);
+    setHighlightChanges(m_highlightChanges);
+}
+
+void TextDocumentUpdater::setHighlightChanges(bool highlight)
+{
+    m_highlightChanges = highlight;
+    clearChangeMarkers();
+    if (!m_highlightChanges) {
+        return;
+    }
+
+    KTextEditor::Attribute::Ptr attr(new KTextEditor::Attribute);
+    attr->setBackground(KColorScheme(QPalette::Active, KColorScheme::View).background(KColorScheme::NeutralBackground));
+    for (const auto &hunk : m_lastChanges) {
+        if (hunk.newCount == 0) {
+            continue;
+        }
+        const auto lastLine = hunk.newBegin + hunk.newCount - 1;
+        std::unique_ptr<KTextEditor::MovingRange> marker(m_doc->newMovingRange({hunk.newBegin, 0, lastLine, m_lines.at(lastLine).size()}));
+        marker->setAttribute(attr);
+        m_changeMarkers.push_back(std::move(marker));
+    }
+}
+
+void TextDocumentUpdater::clearChangeMarkers()
+{
+    m_changeMarkers.clear();
+}
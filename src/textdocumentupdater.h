@@ -0,0 +1,71 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef TEXTDOCUMENTUPDATER_H
+#define TEXTDOCUMENTUPDATER_H
+
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+#include <vector>
+
+namespace KTextEditor {
+class Document;
+class MovingRange;
+}
+
+/** Line-based difference between two texts. */
+namespace TextDiff
+{
+/** A range of lines in the old text replaced by a range of lines in the new text. */
+class Hunk
+{
+public:
+    int oldBegin = 0;
+    int oldCount = 0;
+    int newBegin = 0;
+    int newCount = 0;
+};
+
+/** Computes the hunks turning @p oldLines into @p newLines, in ascending order.
+ *  Runtime is proportional to the size of the change, memory to its square. Changes exceeding
+ *  @p maxEditDistance, or needing too many line comparisons to find, are reported as a single hunk
+ *  covering everything between the common prefix and suffix.
+ */
+std::vector<Hunk> diff(const QStringList &oldLines, const QStringList &newLines, int maxEditDistance = 500);
+}
+
+/** Updates a (read-only) KTextEditor document by only replacing the lines that actually changed.
+ *  This keeps scroll position, folding and highlighting state intact, and optionally marks
+ *  the changed lines.
+ *
+ *  Pretty-printed JSON has one member or value per line, so this effectively is a structural
+ *  diff for the JSON output documents.
+ */
+class TextDocumentUpdater : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TextDocumentUpdater(KTextEditor::Document *doc);
+    ~TextDocumentUpdater();
+
+    /** Changes the document content to @p text. */
+    void setText(const QString &text);
+    /** Highlight the lines changed by the last setText() call. */
+    void setHighlightChanges(bool highlight);
+
+private:
+    void clearChangeMarkers();
+
+    KTextEditor::Document *m_doc;
+    QStringList m_lines;
+    std::vector<TextDiff::Hunk> m_lastChanges;
+    std::vector<std::unique_ptr<KTextEditor::MovingRange>> m_changeMarkers;
+    bool m_highlightChanges = true;
+};
+
+#endif // TEXTDOCUMENTUPDATER_H
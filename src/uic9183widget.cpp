@@ -27,6 +27,8 @@
 using namespace Qt::Literals;
 using namespace KItinerary;
 
+constexpr inline int ContentPreviewSize = 256;
+
 Uic9183Widget::Uic9183Widget(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::Uic9183Widget)
@@ -45,17 +47,16 @@ Uic9183Widget::Uic9183Widget(QWidget *parent)
     ui->blockView->setModel(m_uic9183BlockModel);
     ui->blockView->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
     connect(ui->blockView, &QTreeView::customContextMenuRequested, this, [this](QPoint pos) {
-        auto idx = ui->blockView->currentIndex();
+        const auto idx = ui->blockView->currentIndex();
         if (!idx.isValid())
             return;
-        idx = idx.sibling(idx.row(), 3);
 
         QMenu menu;
         const auto copyContent = menu.addAction(i18n("Copy Content"));
         auto action = menu.exec(ui->blockView->viewport()->mapToGlobal(pos));
         if (action == copyContent) {
             auto md = new QMimeData;
-            md->setData(QStringLiteral("application/octet-stream"), idx.data(Qt::UserRole).toByteArray());
+            md->setData(QStringLiteral("application/octet-stream"), blockContent(idx.row()));
             QGuiApplication::clipboard()->setMimeData(md);
         }
     });
@@ -115,6 +116,7 @@ void Uic9183Widget::clear()
     StandardItemModelHelper::clearContent(m_vendor0080BLModel);
     StandardItemModelHelper::clearContent(m_vendor0080BLOrderModel);
     StandardItemModelHelper::clearContent(m_genericBlockModel);
+    ui->blockHexView->clear();
 }
 
 void Uic9183Widget::setContent(const KItinerary::Uic9183Parser &p)
@@ -136,8 +138,8 @@ void Uic9183Widget::setContent(const KItinerary::Uic9183Parser &p)
         auto versionItem = new QStandardItem(QString::number(block.version()));
         auto sizeItem = new QStandardItem(QString::number(block.contentSize()));
         auto contentItem = new QStandardItem;
-        contentItem->setData(QByteArray(block.content(), block.contentSize()), Qt::UserRole);
-        contentItem->setData(QString::fromUtf8(block.content(), block.contentSize()), Qt::DisplayRole);
+        // the full content is available from the details view, don't put huge strings into a table cell
+        contentItem->setData(QString::fromUtf8(block.content(), std::min(block.contentSize(), ContentPreviewSize)), Qt::DisplayRole);
         m_uic9183BlockModel->appendRow({nameItem, versionItem, sizeItem, contentItem});
         block = block.nextBlock();
     }
@@ -192,7 +194,7 @@ void Uic9183Widget::blockSelectionChanged()
             auto item = StandardItemModelHelper::addEntry(i18n("Ticket %1", i + 1), {}, m_genericBlockModel->invisibleRootItem());
             StandardItemModelHelper::fillFromGadget(ticket, item);
             StandardItemModelHelper::fillFromGadget(ticket->validityArea, item);
-            StandardItemModelHelper::addEntry(i18n("Payload"), StandardItemModelHelper::dataToHex((const uint8_t*)&ticket->validityArea, ticket->validityAreaDataSize, sizeof(VdvTicketValidityAreaData)), item);
+            StandardItemModelHelper::addDataEntry(i18n("Payload"), (const uint8_t*)&ticket->validityArea + sizeof(VdvTicketValidityAreaData), ticket->validityAreaDataSize - (qsizetype)sizeof(VdvTicketValidityAreaData), item, {});
         }
         ui->genericBlockView->expandAll();
         ui->detailsStack->setCurrentWidget(ui->genericPage);
@@ -210,8 +212,19 @@ void Uic9183Widget::blockSelectionChanged()
         if (m_genericBlockModel->rowCount() > 0) {
             ui->detailsStack->setCurrentWidget(ui->genericPage);
         } else {
-            ui->detailsStack->setCurrentWidget(ui->noDetailsPage);
+            ui->blockHexView->setData(blockContent(sel.at(0).row()));
+            ui->detailsStack->setCurrentWidget(ui->rawPage);
         }
     }
     ui->genericBlockView->expandAll();
 }
+
+QByteArray Uic9183Widget::blockContent(int row) const
+{
+    // blocks are only copied when actually needed, tickets can contain rather large ones
+    auto block = m_uic9183.firstBlock();
+    for (int i = 0; i < row && !block.isNull(); ++i) {
+        block = block.nextBlock();
+    }
+    return block.isNull() ? QByteArray() : QByteArray(block.content(), block.contentSize());
+}
@@ -34,6 +34,8 @@ public:
 
 private:
     void blockSelectionChanged();
+    /** Copy of the content of the block in @p row of the block list. */
+    QByteArray blockContent(int row) const;
 
     std::unique_ptr<Ui::Uic9183Widget> ui;
 
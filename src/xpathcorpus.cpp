@@ -0,0 +1,171 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "xpathcorpus.h"
+#include "extractorpipeline.h"
+
+#include <KItinerary/ExtractorDocumentNode>
+#include <KItinerary/ExtractorDocumentProcessor>
+#include <KItinerary/ExtractorEngine>
+#include <KItinerary/HtmlDocument>
+
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
+
+#include <algorithm>
+#include <memory>
+
+using namespace KItinerary;
+
+// like ExtractorEngine::extract() does it, but without running any extractor
+static void expandNode(ExtractorDocumentNode &node, const ExtractorEngine *engine)
+{
+    // HTML can't be embedded in PDF documents, and expanding those would render their images
+    if (node.isNull() || node.mimeType() == QLatin1String("application/pdf")) {
+        return;
+    }
+    node.processor()->expandNode(node, engine);
+    for (auto child : node.childNodes()) {
+        expandNode(child, engine);
+    }
+}
+
+static void evaluateNode(const ExtractorDocumentNode &node, const QString &query, XPathSample &sample)
+{
+    if (node.mimeType() == QLatin1String("text/html")) {
+        if (const auto html = node.content<HtmlDocument*>()) {
+            QElapsedTimer timer;
+            timer.start();
+            const auto res = html->eval(query);
+            sample.elapsedNs += timer.nsecsElapsed();
+            ++sample.documentCount;
+            if (res.canConvert<QVariantList>()) {
+                sample.matchCount += (int)res.value<QVariantList>().size();
+            } else if (res.toBool()) {
+                ++sample.matchCount;
+            }
+        }
+    }
+    for (const auto &child : node.childNodes()) {
+        evaluateNode(child, query, sample);
+    }
+}
+
+XPathCorpusEvaluator::XPathCorpusEvaluator() = default;
+XPathCorpusEvaluator::~XPathCorpusEvaluator() = default;
+
+void XPathCorpusEvaluator::setQuery(const QString &query)
+{
+    m_query = query;
+}
+
+void XPathCorpusEvaluator::setJobCount(int jobs)
+{
+    m_jobs = std::max(1, jobs);
+}
+
+void XPathCorpusEvaluator::addPath(const QString &path)
+{
+    if (!QFileInfo(path).isDir()) {
+        m_files.push_back(path);
+        return;
+    }
+
+    QDirIterator it(path, QDir::Files | QDir::Readable, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while (it.hasNext()) {
+        m_files.push_back(it.next());
+    }
+}
+
+std::vector<XPathSample> XPathCorpusEvaluator::exec()
+{
+    std::vector<XPathSample> samples(m_files.size());
+    m_nextFile = 0;
+
+    const auto jobs = std::min<qsizetype>(m_jobs, m_files.size());
+    std::vector<std::unique_ptr<QThread>> workers;
+    workers.reserve(jobs);
+    for (auto i = 0; i < jobs; ++i) {
+        workers.emplace_back(QThread::create([this, &samples]() { runWorker(samples); }));
+        workers.back()->start();
+    }
+    for (const auto &worker : workers) {
+        worker->wait();
+    }
+
+    if (m_canceled) {
+        samples.clear();
+    }
+    return samples;
+}
+
+void XPathCorpusEvaluator::cancel()
+{
+    m_canceled = true;
+}
+
+void XPathCorpusEvaluator::runWorker(std::vector<XPathSample> &samples)
+{
+    for (auto i = m_nextFile++; i < m_files.size() && !m_canceled; i = m_nextFile++) {
+        samples[i].fileName = m_files.at(i);
+        processFile(samples[i]);
+    }
+}
+
+void XPathCorpusEvaluator::processFile(XPathSample &sample)
+{
+    ExtractorInput input;
+    if (!ExtractorPipeline::loadFile(input, sample.fileName, &sample.error)) {
+        return;
+    }
+
+    ExtractorEngine engine;
+    engine.setData(input.data, sample.fileName);
+    auto root = engine.rootDocumentNode();
+    expandNode(root, &engine);
+    evaluateNode(root, m_query, sample);
+    engine.clear();
+}
+
+qint64 XPathCorpusEvaluator::elapsedPercentile(const std::vector<XPathSample> &samples, int percent)
+{
+    std::vector<qint64> elapsed;
+    elapsed.reserve(samples.size());
+    for (const auto &sample : samples) {
+        if (sample.documentCount > 0) {
+            elapsed.push_back(sample.elapsedNs);
+        }
+    }
+    if (elapsed.empty()) {
+        return 0;
+    }
+
+    const auto it = elapsed.begin() + std::min<qsizetype>((qsizetype)elapsed.size() * percent / 100, (qsizetype)elapsed.size() - 1);
+    std::nth_element(elapsed.begin(), it, elapsed.end());
+    return *it;
+}
+
+int XPathCorpusEvaluator::highMatchThreshold(const std::vector<XPathSample> &samples)
+{
+    std::vector<int> counts;
+    counts.reserve(samples.size());
+    for (const auto &sample : samples) {
+        if (sample.matchCount > 0) {
+            counts.push_back(sample.matchCount);
+        }
+    }
+    if (counts.empty()) {
+        return 0;
+    }
+
+    // outlier fence based on the interquartile range, robust against a few extreme samples
+    std::sort(counts.begin(), counts.end());
+    const auto q1 = counts[counts.size() / 4];
+    const auto q3 = counts[counts.size() * 3 / 4];
+    return q3 + 3 * std::max(1, q3 - q1);
+}
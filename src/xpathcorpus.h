@@ -0,0 +1,67 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef XPATHCORPUS_H
+#define XPATHCORPUS_H
+
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <vector>
+
+/** Result of evaluating an XPath expression on one sample file. */
+class XPathSample
+{
+public:
+    QString fileName;
+    QString error;
+    /** Number of HTML documents found in the sample, e.g. several parts of a multipart mail. */
+    int documentCount = 0;
+    int matchCount = 0;
+    /** XPath evaluation time summed over all documents, excluding loading and parsing. */
+    qint64 elapsedNs = 0;
+};
+
+/** Evaluates an XPath expression on all HTML documents in a set of sample files.
+ *  Shows how robust a selector is across many variants of a document, and how expensive it is.
+ */
+class XPathCorpusEvaluator
+{
+public:
+    XPathCorpusEvaluator();
+    ~XPathCorpusEvaluator();
+
+    void setQuery(const QString &query);
+    /** Number of parallel workers. */
+    void setJobCount(int jobs);
+    /** Adds a file, or all files in a directory recursively. */
+    void addPath(const QString &path);
+
+    /** Evaluates the query on all samples, blocks until done.
+     *  Can be called from any thread.
+     */
+    std::vector<XPathSample> exec();
+    /** Makes a running exec() return early, from any thread. */
+    void cancel();
+
+    /** Evaluation time in nanoseconds below which @p percent percent of the HTML samples are. */
+    static qint64 elapsedPercentile(const std::vector<XPathSample> &samples, int percent);
+    /** Match count above which a sample has unusually many matches, compared to all other samples. */
+    static int highMatchThreshold(const std::vector<XPathSample> &samples);
+
+private:
+    void runWorker(std::vector<XPathSample> &samples);
+    void processFile(XPathSample &sample);
+
+    QString m_query;
+    QStringList m_files;
+    int m_jobs = 1;
+    std::atomic<qsizetype> m_nextFile = 0;
+    std::atomic<bool> m_canceled = false;
+};
+
+#endif // XPATHCORPUS_H
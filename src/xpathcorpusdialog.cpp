@@ -0,0 +1,110 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "xpathcorpusdialog.h"
+
+#include <KColorScheme>
+#include <KLocalizedString>
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLocale>
+#include <QStandardItemModel>
+#include <QTreeView>
+#include <QVBoxLayout>
+
+enum {
+    FileColumn,
+    MatchColumn,
+    ElapsedColumn,
+    DocumentColumn,
+};
+
+static QString formatMs(qint64 ns)
+{
+    return QLocale().toString(ns / 1'000'000.0, 'f', 2);
+}
+
+XPathCorpusDialog::XPathCorpusDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_summaryLabel(new QLabel(this))
+    , m_model(new QStandardItemModel(this))
+{
+    setWindowTitle(i18n("XPath Sample Evaluation"));
+    resize(800, 600);
+
+    auto layout = new QVBoxLayout(this);
+    m_summaryLabel->setWordWrap(true);
+    m_summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(m_summaryLabel);
+
+    m_model->setHorizontalHeaderLabels({i18n("Sample"), i18n("Matches"), i18n("Time (ms)"), i18n("HTML Documents")});
+    auto view = new QTreeView(this);
+    view->setRootIsDecorated(false);
+    view->setSortingEnabled(true);
+    view->setModel(m_model);
+    view->header()->setSectionResizeMode(FileColumn, QHeaderView::Stretch);
+    view->header()->setStretchLastSection(false);
+    layout->addWidget(view);
+    connect(view, &QTreeView::activated, this, [this](const QModelIndex &idx) {
+        Q_EMIT sampleActivated(idx.siblingAtColumn(FileColumn).data(Qt::UserRole).toString());
+    });
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+}
+
+XPathCorpusDialog::~XPathCorpusDialog() = default;
+
+void XPathCorpusDialog::setResult(const QString &query, const std::vector<XPathSample> &samples)
+{
+    m_model->removeRows(0, m_model->rowCount());
+
+    const auto threshold = XPathCorpusEvaluator::highMatchThreshold(samples);
+    const KColorScheme colors(QPalette::Normal);
+    int htmlCount = 0;
+    int noMatchCount = 0;
+    int highMatchCount = 0;
+    int errorCount = 0;
+    for (const auto &sample : samples) {
+        auto fileItem = new QStandardItem(sample.fileName);
+        fileItem->setData(sample.fileName, Qt::UserRole);
+        auto matchItem = new QStandardItem;
+        auto elapsedItem = new QStandardItem;
+        auto docItem = new QStandardItem;
+
+        if (!sample.error.isEmpty()) {
+            ++errorCount;
+            fileItem->setToolTip(sample.error);
+            fileItem->setForeground(colors.foreground(KColorScheme::NegativeText));
+        } else if (sample.documentCount > 0) {
+            ++htmlCount;
+            matchItem->setData(sample.matchCount, Qt::DisplayRole);
+            elapsedItem->setData(sample.elapsedNs / 1'000'000.0, Qt::DisplayRole);
+            docItem->setData(sample.documentCount, Qt::DisplayRole);
+            if (sample.matchCount == 0) {
+                ++noMatchCount;
+                matchItem->setBackground(colors.background(KColorScheme::NegativeBackground));
+            } else if (sample.matchCount > threshold) {
+                ++highMatchCount;
+                matchItem->setBackground(colors.background(KColorScheme::NeutralBackground));
+            }
+        }
+        m_model->appendRow({fileItem, matchItem, elapsedItem, docItem});
+    }
+
+    m_summaryLabel->setText(i18n("<b>%1</b><br/>"
+        "%2 samples, %3 with HTML content, %4 unreadable.<br/>"
+        "No matches: %5, unusually many matches (more than %6): %7.<br/>"
+        "Evaluation time: median %8 ms, 90%: %9 ms, 99%: %10 ms, max %11 ms.",
+        query.toHtmlEscaped(), (int)samples.size(), htmlCount, errorCount, noMatchCount, threshold, highMatchCount,
+        formatMs(XPathCorpusEvaluator::elapsedPercentile(samples, 50)),
+        formatMs(XPathCorpusEvaluator::elapsedPercentile(samples, 90)),
+        formatMs(XPathCorpusEvaluator::elapsedPercentile(samples, 99)),
+        formatMs(XPathCorpusEvaluator::elapsedPercentile(samples, 100))));
+}
@@ -0,0 +1,36 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef XPATHCORPUSDIALOG_H
+#define XPATHCORPUSDIALOG_H
+
+#include "xpathcorpus.h"
+
+#include <QDialog>
+
+class QLabel;
+class QStandardItemModel;
+
+/** Report of evaluating an XPath expression on a set of sample files. */
+class XPathCorpusDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit XPathCorpusDialog(QWidget *parent = nullptr);
+    ~XPathCorpusDialog();
+
+    void setResult(const QString &query, const std::vector<XPathSample> &samples);
+
+Q_SIGNALS:
+    /** Emitted when the user wants to open the sample @p fileName. */
+    void sampleActivated(const QString &fileName);
+
+private:
+    QLabel *m_summaryLabel = nullptr;
+    QStandardItemModel *m_model = nullptr;
+};
+
+#endif // XPATHCORPUSDIALOG_H